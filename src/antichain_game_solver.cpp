@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+
+#define BDD spotBDD
+    #include <spot/twa/twagraph.hh>
+    #include <spot/twaalgos/sccinfo.hh>
+#undef BDD
+
+
+#include "antichain_game_solver.hpp"
+#include "atm_helper.hpp"
+#include "utils.hpp"
+
+
+using namespace std;
+
+
+#define hmap unordered_map
+
+
+sdf::AntichainGameSolver::AntichainGameSolver(bool is_moore_,
+                                              const std::unordered_set<spot::formula>& inputs_,
+                                              const std::unordered_set<spot::formula>& outputs_,
+                                              const spot::twa_graph_ptr& ucw_,  // NOLINT(*-pass-by-value)
+                                              const std::vector<uint>& k_by_scc_,
+                                              uint time_limit_sec_) :
+    LocalGameSolver(is_moore_, inputs_, outputs_, ucw_,
+                    false,  // the reachable latch valuations are exactly the winning nodes reachable under the strategy
+                    time_limit_sec_),
+    k_by_scc(k_by_scc_),
+    max_k(*max_element(k_by_scc_.begin(), k_by_scc_.end()))
+{
+    MASSERT(aut->is_sba().is_true(), "currently, only SBA is supported");
+
+    spot::scc_info scc_info(aut);
+    MASSERT(k_by_scc.size() == scc_info.scc_count(), "the bounds must be given for every SCC");
+    for (uint q = 0; q < aut->num_states(); ++q)
+    {
+        scc_of.push_back(scc_info.scc_of(q));
+        is_sink.push_back(is_acc_sink(aut, q));
+    }
+}
+
+
+bool sdf::AntichainGameSolver::is_at_least_as_hard(const vector<uint>& a, const vector<uint>& b) const
+{
+    auto it = a.begin();
+    for (auto code_b: b)
+    {
+        auto q = state_of(code_b);
+        while (it != a.end() && state_of(*it) < q)
+            ++it;
+        if (it == a.end() || state_of(*it) != q || budget_of(*it) > budget_of(code_b))
+            return false;
+    }
+    return true;
+}
+
+
+vector<uint> sdf::AntichainGameSolver::get_initial_node_states()
+{
+    auto q0 = aut->get_init_state_number();
+    if (is_sink[q0])
+        return {ERROR_CODE};
+    return {encode(q0, k_by_scc[scc_of[q0]])};
+}
+
+
+const vector<pair<BDD, vector<uint>>>& sdf::AntichainGameSolver::get_out_groups(uint code)
+{
+    auto it = out_groups_by_code.find(code);
+    if (it != out_groups_by_code.end())
+        return it->second;
+
+    // the budget is updated as in k_reduce:
+    // it decreases when we leave a rejecting state within an SCC, and is reset when we change the SCC
+    auto q = state_of(code);
+    auto c = budget_of(code);
+    vector<pair<BDD, vector<uint>>> groups;
+    for (const auto& [label, dsts]: out_by_state[q])
+    {
+        vector<uint> dst_codes;
+        for (auto dst: dsts)
+        {
+            int dst_c = scc_of[q] == scc_of[dst]
+                        ? (int) c - aut->state_is_accepting(q)
+                        : (int) k_by_scc[scc_of[dst]];
+            dst_codes.push_back(dst_c == -1 || is_sink[dst] ? ERROR_CODE : encode(dst, dst_c));
+        }
+        sort(dst_codes.begin(), dst_codes.end());
+        dst_codes.erase(unique(dst_codes.begin(), dst_codes.end()), dst_codes.end());
+        groups.emplace_back(label, dst_codes);
+    }
+    return out_groups_by_code.emplace(code, move(groups)).first->second;
+}
+
+
+vector<pair<BDD, vector<uint>>> sdf::AntichainGameSolver::compute_successors(const vector<uint>& states)
+{
+    // keep only the smallest budget for every state, then merge the blocks that became equal
+    vector<pair<BDD, vector<uint>>> result;
+    hmap<vector<uint>, size_t, StatesHash> block_by_succ;
+    for (auto& [block, succ]: ExplicitGameSolver::compute_successors(states))
+    {
+        vector<uint> min_succ;
+        for (auto code: succ)  // (sorted, hence the codes of the same state are adjacent and the smallest budget goes first)
+            if (code == ERROR_CODE || min_succ.empty() || state_of(min_succ.back()) != state_of(code))
+                min_succ.push_back(code);
+
+        auto [it, is_new] = block_by_succ.emplace(min_succ, result.size());
+        if (is_new)
+            result.emplace_back(block, move(min_succ));
+        else
+            result[it->second].first |= block;
+    }
+    return result;
+}
+
+
+bool sdf::AntichainGameSolver::is_error(const vector<uint>& states)
+{
+    return !states.empty() && states.back() == ERROR_CODE;
+}
+
+
+bool sdf::AntichainGameSolver::is_known_losing(const vector<uint>& states)
+{
+    return any_of(losing_antichain.begin(), losing_antichain.end(),
+                  [&](const vector<uint>& losing) { return is_at_least_as_hard(states, losing); });
+}
+
+
+void sdf::AntichainGameSolver::on_losing(uint n)
+{
+    const auto& states = nodes[n].states;
+    if (is_known_losing(states))
+        return;
+
+    // `states` is less hard than the antichain elements it is dominated by, so they are not needed anymore
+    losing_antichain.erase(remove_if(losing_antichain.begin(), losing_antichain.end(),
+                                     [&](const vector<uint>& losing) { return is_at_least_as_hard(losing, states); }),
+                           losing_antichain.end());
+    losing_antichain.push_back(states);
+}
+
+
+optional<set<uint>> sdf::AntichainGameSolver::get_exhausted_sccs()
+{
+    // A run gets exhausted when it leaves a rejecting state with the budget 0 within the SCC.
+    // The pruned (dominated) losing nodes are not expanded, but their dominators are.
+    set<uint> exhausted;
+    for (const auto& node: nodes)
+    {
+        if (!node.is_losing || !node.is_expanded)
+            continue;
+        for (auto code: node.states)
+        {
+            auto q = state_of(code);
+            if (budget_of(code) != 0 || !aut->state_is_accepting(q))
+                continue;
+            for (const auto& t: aut->out(q))
+                if (scc_of[t.dst] == scc_of[q])
+                {
+                    exhausted.insert(scc_of[q]);
+                    break;
+                }
+        }
+    }
+    return exhausted;
+}
+
+
+BDD sdf::AntichainGameSolver::get_nondet_strategy()
+{
+    spdlog::info("get_nondet_strategy (antichain)..");
+
+    // One latch per winning node: when following the strategy, exactly one latch is set,
+    // and a latch is set iff some move of the strategy leads to its node.
+    // (On termination, the moves of expanded non-losing nodes lead to expanded non-losing nodes.)
+
+    vector<uint> winning_nodes;
+    for (uint n = 0; n < nodes.size(); ++n)
+        if (nodes[n].is_expanded && !nodes[n].is_losing)
+            winning_nodes.push_back(n);
+
+    hmap<uint, uint> latch_by_node;  // node -> cudd index
+    vector<BDD> latch_vars;
+    for (auto n: winning_nodes)
+    {
+        uint cuddIdx = NOF_SIGNALS + latch_vars.size();
+        latch_vars.push_back(cudd.bddVar((int)cuddIdx));
+        cudd.pushVariableName("n" + to_string(n));
+        latch_by_node[n] = cuddIdx;
+        pre_trans_func[cuddIdx] = cudd.bddZero();
+    }
+
+    BDD strategy = cudd.bddZero();
+    for (auto n: winning_nodes)
+    {
+        auto n_var = cudd.ReadVars((int)latch_by_node.at(n));
+        for (const auto& m: nodes[n].moves)
+            if (latch_by_node.count(m.dst))
+                pre_trans_func[latch_by_node.at(m.dst)] |= n_var & m.label;
+        strategy |= n_var & nodes[n].safe;
+    }
+
+    vector<int> phases(latch_vars.size(), 0);
+    phases[latch_by_node.at(0) - NOF_SIGNALS] = 1;
+    init = cudd.bddComputeCube(latch_vars.data(), phases.data(), (int)latch_vars.size());
+    init_latches = {latch_by_node.at(0)};
+    error = cudd.bddZero();  // the latch valuations reachable under the strategy never describe error nodes
+
+    spdlog::info("get_nondet_strategy: {} latches", latch_vars.size());
+
+    return strategy;
+}
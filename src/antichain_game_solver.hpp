@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "local_game_solver.hpp"
+
+
+namespace sdf
+{
+
+/**
+ * Solver for the k-co-Büchi game that works directly on the UCW (no k-reduction).
+ *
+ * A node is a counting function: it maps every UCW state visited by some run to
+ * the number of visits to rejecting states (of the current SCC) the runs in that state can still afford,
+ * where we keep only the smallest number for each state (a run with a smaller budget dominates).
+ * The counting functions are ordered by domination:
+ * f is at least as hard as g iff every state of g is in f with at most the same budget.
+ * Adam wins from f if he wins from some g that f dominates,
+ * so the losing nodes are represented by the antichain of their least hard elements,
+ * and the newly discovered nodes that are harder than one of them are losing without exploration.
+ * The nodes are explored on-the-fly from the initial one (see LocalGameSolver).
+ *
+ * The synthesized model has one latch per winning node (the reachable latch valuations are one-hot).
+ */
+class AntichainGameSolver : public LocalGameSolver
+{
+
+public:
+    AntichainGameSolver(bool is_moore_,
+                        const std::unordered_set<spot::formula>& inputs_,
+                        const std::unordered_set<spot::formula>& outputs_,
+                        const spot::twa_graph_ptr& ucw_,  // NOLINT(*-pass-by-value)
+                        const std::vector<uint>& k_by_scc_,  // the bound for every SCC (see k_reduce)
+                        uint time_limit_sec_ = 3600);
+
+    /** @return the SCCs of the rejecting states with the budget 0 in the losing nodes */
+    std::optional<std::set<uint>> get_exhausted_sccs() override;
+
+protected:
+    static const uint ERROR_CODE = (uint) -1;  // (the largest code, hence it goes last in sorted node states)
+
+    const std::vector<uint> k_by_scc;
+    const uint max_k;
+    std::vector<uint> scc_of;                   // UCW state -> SCC
+    std::vector<bool> is_sink;                  // UCW state -> is accepting sink?
+    std::unordered_map<uint, std::vector<std::pair<BDD, std::vector<uint>>>> out_groups_by_code;
+    std::vector<std::vector<uint>> losing_antichain;
+
+protected:
+    // node states are codes of (UCW state, budget) pairs, sorted
+    uint encode(uint q, uint c) const { return q*(max_k+1) + c; }
+    uint state_of(uint code) const { return code / (max_k+1); }
+    uint budget_of(uint code) const { return code % (max_k+1); }
+
+    /** @return true iff every state of `b` is in `a` with at most the same budget */
+    bool is_at_least_as_hard(const std::vector<uint>& a, const std::vector<uint>& b) const;
+
+    std::vector<uint> get_initial_node_states() override;
+
+    const std::vector<std::pair<BDD, std::vector<uint>>>& get_out_groups(uint code) override;
+
+    std::vector<std::pair<BDD, std::vector<uint>>> compute_successors(const std::vector<uint>& states) override;
+
+    bool is_error(const std::vector<uint>& states) override;
+
+    bool is_known_losing(const std::vector<uint>& states) override;
+
+    void on_losing(uint n) override;
+
+    BDD get_nondet_strategy() override;
+
+    /** (the latches encode the nodes, not the UCW states) */
+    std::optional<BDD> compute_reachable_explicitly() override { return std::nullopt; }
+};
+
+
+} // namespace sdf
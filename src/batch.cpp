@@ -0,0 +1,430 @@
+#include "batch.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#define BDD spotBDD
+    #include <spot/twa/twagraph.hh>
+#undef BDD
+
+extern "C"
+{
+    #include <aiger.h>
+}
+
+#include "ltl_parser.hpp"
+#include "ehoa_parser.hpp"
+#include "syntcomp_constants.hpp"
+#include "utils.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+#define hset unordered_set
+
+
+using Clock = chrono::steady_clock;
+
+
+vector<string> sdf::collect_spec_files(const vector<string>& paths)
+{
+    vector<string> files;
+    for (const auto& path: paths)
+    {
+        if (!filesystem::is_directory(path))
+        {
+            files.push_back(path);
+            continue;
+        }
+        vector<string> dir_files;
+        for (const auto& entry: filesystem::directory_iterator(path))
+        {
+            auto ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".tlsf" || ext == ".ehoa" || ext == ".hoa"))
+                dir_files.push_back(entry.path().string());
+        }
+        sort(dir_files.begin(), dir_files.end());
+        files.insert(files.end(), dir_files.begin(), dir_files.end());
+    }
+    return files;
+}
+
+
+static string json_escape(const string& s)
+{
+    stringstream ss;
+    for (char c: s)
+        switch (c)
+        {
+            case '"': ss << "\\\""; break;
+            case '\\': ss << "\\\\"; break;
+            case '\n': ss << "\\n"; break;
+            case '\t': ss << "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20)
+                    ss << "\\u" << hex << setw(4) << setfill('0') << (int)c << dec;
+                else
+                    ss << c;
+        }
+    return ss.str();
+}
+
+
+static double sec_since(Clock::time_point start)
+{
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+string sdf::make_error_result(const string& spec_file, const string& verdict, const string& error)
+{
+    return "{\"spec\": \"" + json_escape(spec_file) + "\", \"verdict\": \"" + verdict + "\", "
+           "\"error\": \"" + json_escape(error) + "\"}";
+}
+
+
+bool sdf::is_failed_result(const string& json_line)
+{
+    return json_line.find("\"verdict\": \"ERROR\"") != string::npos ||
+           json_line.find("\"verdict\": \"TIMEOUT\"") != string::npos;
+}
+
+
+/** (runs in a worker; the empty text means the spec is read from the file) */
+static string solve_spec(const BatchDescr& batch_descr, const string& spec_file, const string& text)
+{
+    auto start = Clock::now();
+    try
+    {
+        bool is_tlsf = spec_file.ends_with(".tlsf");
+        MASSERT(is_tlsf || !batch_descr.check_unreal, "the unrealizability check is supported for TLSF only");
+
+        spot::twa_graph_ptr ucw;
+        hset<spot::formula> inputs, outputs;
+        bool is_moore;
+        double parse_sec, translation_sec = 0;
+        if (is_tlsf)
+        {
+            spot::formula formula;
+            tie(formula, inputs, outputs, is_moore) = text.empty() ? parse_tlsf(spec_file) : parse_tlsf_string(text);
+            if (batch_descr.check_unreal)
+            {   // (as in run_tlsf)
+                formula = spot::formula::Not(formula);
+                swap(inputs, outputs);
+                is_moore = !is_moore;
+            }
+            parse_sec = sec_since(start);
+            ucw = translate_to_ucw(formula, batch_descr.tuning.translation_level);
+            translation_sec = sec_since(start) - parse_sec;
+        }
+        else
+        {
+            tie(ucw, inputs, outputs, is_moore) = text.empty() ? read_ehoa(spec_file) : read_ehoa_text(text, spec_file);
+            parse_sec = sec_since(start);
+        }
+
+        auto solving_start = Clock::now();
+        aiger* model = nullptr;
+        SynthStats stats;
+        bool is_real = synthesize_atm(SpecDescr2(ucw, inputs, outputs, is_moore,
+                                                 batch_descr.extract_model, batch_descr.extract_model && batch_descr.do_reach_optim,
+                                                 batch_descr.engine, batch_descr.k_policy, batch_descr.deadline_sec,
+                                                 nullptr, batch_descr.tuning),
+                                      batch_descr.k_to_iterate, model, &stats);
+        auto solving_sec = sec_since(solving_start);
+
+        string verdict = !is_real ? SYNTCOMP_STR_UNKNOWN :
+                         batch_descr.check_unreal ? SYNTCOMP_STR_UNREAL : SYNTCOMP_STR_REAL;
+
+        stringstream json;
+        json << "{\"spec\": \"" << json_escape(spec_file) << "\", \"verdict\": \"" << verdict << "\", "
+             << "\"k\": " << stats.k << ", \"games\": " << stats.nof_games << ", "
+             << "\"parse_sec\": " << parse_sec << ", \"translation_sec\": " << translation_sec << ", "
+             << "\"solving_sec\": " << solving_sec << ", \"total_sec\": " << sec_since(start) << ", "
+             << "\"inputs\": " << inputs.size() << ", \"outputs\": " << outputs.size();
+        if (model != nullptr)
+        {
+            json << ", \"latches\": " << model->num_latches << ", \"ands\": " << model->num_ands;
+            if (!batch_descr.output_dir.empty())
+            {
+                auto model_file = (filesystem::path(batch_descr.output_dir) /
+                                   (filesystem::path(spec_file).filename().string() + ".aag")).string();
+                MASSERT(aiger_open_and_write_to_file(model, model_file.c_str()), "could not write the model to " << model_file);
+            }
+            aiger_reset(model);
+        }
+        json << "}";
+        return json.str();
+    }
+    catch (const exception& e)
+    {
+        return make_error_result(spec_file, "ERROR", e.what());
+    }
+}
+
+
+static void write_all(int fd, const string& data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        MASSERT(n > 0, "write failed");
+        written += n;
+    }
+}
+
+
+/** @return false on EOF */
+static bool read_exact(int fd, size_t n, string& data)
+{
+    data.resize(n);
+    size_t got = 0;
+    while (got < n)
+    {
+        auto r = read(fd, data.data() + got, n - got);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        got += r;
+    }
+    return true;
+}
+
+
+/**
+ * Worker loop: read the tasks `<name length> <text length>\n<name><text>` from `task_fd`,
+ * write one result line per task to `result_fd`.
+ */
+[[noreturn]] static void serve(const BatchDescr& batch_descr, int task_fd, int result_fd)
+{
+    while (true)
+    {
+        string header, c;
+        while (read_exact(task_fd, 1, c) && c != "\n")
+            header += c;
+        if (c != "\n")
+            _exit(0);  // the pool closed the pipe: no more specs
+
+        auto lengths = split_by_space(header);
+        string name, text;
+        if (lengths.size() != 2 || !read_exact(task_fd, stoul(lengths[0]), name) || !read_exact(task_fd, stoul(lengths[1]), text))
+            _exit(1);
+        write_all(result_fd, solve_spec(batch_descr, name, text) + "\n");
+    }
+}
+
+
+sdf::WorkerPool::~WorkerPool()
+{
+    for (auto& w: workers)
+        if (w.pid > 0)
+            stop(w, w.job_id.has_value());  // (an idle worker exits when its task pipe is closed)
+}
+
+
+void sdf::WorkerPool::spawn(Worker& w)
+{
+    int task_pipe[2], result_pipe[2];
+    MASSERT(pipe(task_pipe) == 0 && pipe(result_pipe) == 0, "could not create a pipe");
+
+    cout.flush();
+    pid_t pid = fork();
+    MASSERT(pid >= 0, "could not fork a worker");
+    if (pid == 0)
+    {
+        // the worker must not keep the pipes of the other workers open, otherwise their crashes are not noticed
+        for (const auto& other: workers)
+            if (other.pid > 0)
+            {
+                close(other.task_fd);
+                close(other.result_fd);
+            }
+        for (auto fd: fds_to_close)
+            close(fd);
+        close(task_pipe[1]);
+        close(result_pipe[0]);
+        serve(batch_descr, task_pipe[0], result_pipe[1]);
+    }
+
+    close(task_pipe[0]);
+    close(result_pipe[1]);
+    w = Worker();
+    w.pid = pid;
+    w.task_fd = task_pipe[1];
+    w.result_fd = result_pipe[0];
+}
+
+
+void sdf::WorkerPool::stop(Worker& w, bool kill_it)
+{
+    if (kill_it)
+        kill(w.pid, SIGKILL);
+    close(w.task_fd);
+    close(w.result_fd);
+    waitpid(w.pid, nullptr, 0);
+    w = Worker();
+}
+
+
+uint sdf::WorkerPool::get_nof_idle() const
+{
+    auto nof_busy = count_if(workers.begin(), workers.end(), [](const Worker& w) { return w.job_id.has_value(); });
+    return batch_descr.nof_workers - nof_busy;
+}
+
+
+void sdf::WorkerPool::submit(ulong job_id, const string& name, const string& text)
+{
+    MASSERT(get_nof_idle() > 0, "no idle worker");
+    signal(SIGPIPE, SIG_IGN);  // (a worker can die while we are sending it a task)
+
+    if (workers.size() < batch_descr.nof_workers)
+        workers.emplace_back();
+    auto& w = *find_if(workers.begin(), workers.end(), [](const Worker& w) { return !w.job_id.has_value(); });
+
+    auto task = to_string(name.size()) + " " + to_string(text.size()) + "\n" + name + text;
+    for (uint attempt = 0; ; ++attempt)
+    {
+        if (w.pid < 0)
+            spawn(w);
+        size_t written = 0;
+        while (written < task.size())
+        {
+            auto n = write(w.task_fd, task.data() + written, task.size() - written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            written += n;
+        }
+        if (written == task.size())
+            break;
+        MASSERT(attempt < 3, "could not send the task to a worker");
+        stop(w, true);  // the worker is dead: replace it
+    }
+    w.job_id = job_id;
+    w.name = name;
+    w.started = Clock::now();
+}
+
+
+vector<pollfd> sdf::WorkerPool::get_poll_fds() const
+{
+    vector<pollfd> fds;
+    for (const auto& w: workers)
+        if (w.job_id.has_value())
+            fds.push_back({w.result_fd, POLLIN, 0});
+    return fds;
+}
+
+
+int sdf::WorkerPool::get_poll_timeout_ms() const
+{
+    if (batch_descr.timeout_sec == 0)
+        return -1;
+    int timeout_ms = -1;
+    for (const auto& w: workers)
+        if (w.job_id.has_value())
+        {
+            auto left_ms = max(0l, (long) batch_descr.timeout_sec * 1000 - (long) (sec_since(w.started) * 1000));
+            timeout_ms = (timeout_ms < 0) ? (int) left_ms : min(timeout_ms, (int) left_ms);
+        }
+    return timeout_ms;
+}
+
+
+vector<pair<ulong, string>> sdf::WorkerPool::collect()
+{
+    vector<pair<ulong, string>> results;
+    for (auto& w: workers)
+    {
+        if (!w.job_id.has_value())
+            continue;
+
+        pollfd fd = {w.result_fd, POLLIN, 0};
+        if (poll(&fd, 1, 0) > 0)
+        {
+            char chunk[4096];
+            auto n = read(w.result_fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n > 0)
+            {
+                w.buffer.append(chunk, n);
+                auto eol = w.buffer.find('\n');
+                if (eol != string::npos)
+                {
+                    results.emplace_back(*w.job_id, w.buffer.substr(0, eol));
+                    w.buffer.clear();  // (one spec at a time, so nothing follows the line)
+                    w.job_id.reset();
+                }
+                continue;
+            }
+
+            // the worker died
+            int status = 0;
+            close(w.task_fd);
+            close(w.result_fd);
+            waitpid(w.pid, &status, 0);
+            results.emplace_back(*w.job_id, make_error_result(w.name, "ERROR",
+                                 WIFSIGNALED(status) ? "the worker was killed by signal " + to_string(WTERMSIG(status))
+                                                     : "the worker exited with status " + to_string(WEXITSTATUS(status))));
+            w = Worker();
+            continue;
+        }
+
+        if (batch_descr.timeout_sec > 0 && sec_since(w.started) >= batch_descr.timeout_sec)
+        {
+            results.emplace_back(*w.job_id, make_error_result(w.name, "TIMEOUT", "no verdict after " + to_string(batch_descr.timeout_sec) + " sec"));
+            stop(w, true);
+        }
+    }
+    return results;
+}
+
+
+int sdf::run_batch(const BatchDescr& batch_descr)
+{
+    const auto& files = batch_descr.spec_files;
+    MASSERT(batch_descr.nof_workers > 0, "the number of workers must be positive");
+
+    WorkerPool pool(batch_descr);
+    uint nof_failures = 0;
+    ulong next_idx = 0;
+    while (true)
+    {
+        while (next_idx < files.size() && pool.get_nof_idle() > 0)
+        {
+            pool.submit(next_idx, files[next_idx]);
+            ++next_idx;
+        }
+        if (pool.get_nof_busy() == 0)
+            break;
+
+        auto fds = pool.get_poll_fds();
+        if (poll(fds.data(), fds.size(), pool.get_poll_timeout_ms()) < 0)
+            MASSERT(errno == EINTR, "poll failed");
+
+        for (const auto& [idx, line]: pool.collect())
+        {
+            cout << line << endl;
+            nof_failures += is_failed_result(line);
+        }
+    }
+
+    spdlog::info("batch: {} specs, {} failed", files.size(), nof_failures);
+    return nof_failures == 0 ? 0 : 1;
+}
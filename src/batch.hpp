@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+#include <poll.h>
+
+#include "synthesizer.hpp"
+
+
+namespace sdf
+{
+
+struct BatchDescr
+{
+    std::vector<std::string> spec_files;  // TLSF (*.tlsf) or extended HOA (other extensions)
+    uint nof_workers = 1;
+    std::vector<uint> k_to_iterate = {4};
+    bool check_unreal = false;            // (TLSF only)
+    bool extract_model = false;
+    std::string output_dir;               // where to write the models <spec file name>.aag (empty: do not write)
+    SolverEngine engine = SolverEngine::symbolic;
+    KBoundPolicy k_policy = KBoundPolicy::uniform;
+    bool do_reach_optim = false;          // (with extract_model only)
+    SolverTuning tuning;                  // (the same for every spec, hence no checkpoint)
+    uint deadline_sec = 0;                // per spec: no new k is tried after the deadline
+    uint timeout_sec = 0;                 // per spec: the worker is killed after the timeout (0 means no timeout)
+};
+
+/**
+ * Expand the directories into the spec files they contain (*.tlsf, *.ehoa, *.hoa; not recursive, sorted);
+ * the files are kept as is.
+ */
+std::vector<std::string> collect_spec_files(const std::vector<std::string>& paths);
+
+/** @return the result line (see run_batch) with the verdict (ERROR or TIMEOUT) and the error message */
+std::string make_error_result(const std::string& spec_file, const std::string& verdict, const std::string& error);
+
+/** @return true iff the result line (see run_batch) has the verdict ERROR or TIMEOUT */
+bool is_failed_result(const std::string& json_line);
+
+/**
+ * A pool of forked worker processes that solve one spec at a time each (with the options of BatchDescr).
+ * The workers are forked lazily and solve the specs one after another,
+ * so the process start and the library initialisation are paid once per worker, not once per spec.
+ * (Processes, not threads: spot's BuDDy is a global state and is not thread-safe.)
+ * A crashed or timed-out worker is replaced by a fresh one.
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(BatchDescr batch_descr_) : batch_descr(std::move(batch_descr_)) { }
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /** the file descriptors that the forked workers must close (e.g., the sockets of the caller) */
+    void close_in_workers(int fd) { fds_to_close.push_back(fd); }
+
+    uint get_nof_idle() const;
+    uint get_nof_busy() const { return batch_descr.nof_workers - get_nof_idle(); }
+
+    /**
+     * Start solving the spec on an idle worker (requires get_nof_idle() > 0).
+     * @param text: the spec text, or empty to read the file `name`
+     */
+    void submit(ulong job_id, const std::string& name, const std::string& text = "");
+
+    /** the descriptors to wait for (POLLIN) and the timeout (-1 if none), for the callers running their own poll loop */
+    std::vector<pollfd> get_poll_fds() const;
+    int get_poll_timeout_ms() const;
+
+    /** Handle the ready workers (does not block). @return (job id, result line) of the finished jobs */
+    std::vector<std::pair<ulong, std::string>> collect();
+
+private:
+    struct Worker
+    {
+        pid_t pid = -1;
+        int task_fd = -1;    // (write end)
+        int result_fd = -1;  // (read end)
+        std::optional<ulong> job_id;
+        std::string name;
+        std::chrono::steady_clock::time_point started;
+        std::string buffer; // partial result line
+    };
+
+    const BatchDescr batch_descr;
+    std::vector<Worker> workers;
+    std::vector<int> fds_to_close;
+
+    void spawn(Worker& w);
+    void stop(Worker& w, bool kill_it);
+};
+
+/**
+ * Solve the specs on a pool of worker processes and print one JSON line per spec to stdout (in the order of completion):
+ *
+ *     {"spec": "arbiter.tlsf", "verdict": "REALIZABLE", "k": 2, "games": 2,
+ *      "parse_sec": 0.01, "translation_sec": 0.12, "solving_sec": 0.3, "total_sec": 0.43,
+ *      "inputs": 2, "outputs": 2, "latches": 5, "ands": 31}
+ *
+ * The verdict is one of SYNTCOMP strings or "TIMEOUT" or "ERROR" (then "error" describes it).
+ * The circuit size is present only when the model is extracted.
+ *
+ * @return 0 iff no spec ended with ERROR or TIMEOUT
+ */
+int run_batch(const BatchDescr& batch_descr);
+
+} //namespace sdf
@@ -0,0 +1,235 @@
+#include "bdd_io.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+#include "my_assert.hpp"
+
+
+using namespace std;
+
+
+#define hmap unordered_map
+
+
+static const string MAGIC = "sdf-bdd 1\n";
+
+
+template<typename T>
+static void write_value(ostream& out, T value)
+{
+    out.write((const char*) &value, sizeof(value));
+}
+
+static void write_string(ostream& out, const string& s)
+{
+    write_value<uint32_t>(out, (uint32_t) s.size());
+    out.write(s.data(), (streamsize) s.size());
+}
+
+template<typename T>
+static T read_value(istream& in)
+{
+    T value;
+    in.read((char*) &value, sizeof(value));
+    MASSERT(in, "the BDD file is truncated");
+    return value;
+}
+
+static string read_string(istream& in)
+{
+    string s(read_value<uint32_t>(in), '\0');
+    in.read(s.data(), (streamsize) s.size());
+    MASSERT(in, "the BDD file is truncated");
+    return s;
+}
+
+
+/** the reference to a node in the file: (the node id) << 1 | (the complement bit), where the id 0 is the constant one */
+static uint64_t number_nodes(DdNode* node, hmap<DdNode*, uint64_t>& id_by_node, vector<DdNode*>& nodes)
+{
+    auto regular = Cudd_Regular(node);
+    auto complement = (uint64_t) Cudd_IsComplement(node);
+    if (Cudd_IsConstant(regular))
+        return complement;
+
+    auto it = id_by_node.find(regular);
+    if (it != id_by_node.end())
+        return it->second << 1 | complement;
+
+    number_nodes(Cudd_T(regular), id_by_node, nodes);
+    number_nodes(Cudd_E(regular), id_by_node, nodes);
+    nodes.push_back(regular);
+    auto id = (uint64_t) nodes.size();  // (children first)
+    id_by_node[regular] = id;
+    return id << 1 | complement;
+}
+
+
+void sdf::save_bdds(const Cudd& cudd,
+                    const vector<pair<string, BDD>>& bdd_by_name,
+                    const string& file_name)
+{
+    hmap<DdNode*, uint64_t> id_by_node;
+    vector<DdNode*> nodes;
+    vector<pair<string, uint64_t>> roots;
+    for (const auto& [name, bdd]: bdd_by_name)
+        roots.emplace_back(name, number_nodes(bdd.getNode(), id_by_node, nodes));
+
+    uint32_t nof_vars = 0;
+    for (auto node: nodes)
+        nof_vars = max(nof_vars, (uint32_t) Cudd_NodeReadIndex(node) + 1);
+
+    // write to a temporary file first: a crash while writing leaves the previous checkpoint intact
+    auto tmp_file_name = file_name + ".tmp";
+    {
+        ofstream out(tmp_file_name, ios::binary);
+        MASSERT(out, "could not open " << tmp_file_name);
+        out << MAGIC;
+
+        write_value<uint32_t>(out, nof_vars);
+        for (uint32_t i = 0; i < nof_vars; ++i)
+        {
+            write_string(out, cudd.getVariableName(i));
+            write_value<int32_t>(out, cudd.ReadPerm((int) i));
+        }
+
+        auto ref = [&](DdNode* child)
+        {
+            auto regular = Cudd_Regular(child);
+            auto complement = (uint64_t) Cudd_IsComplement(child);
+            return Cudd_IsConstant(regular) ? complement : id_by_node.at(regular) << 1 | complement;
+        };
+        write_value<uint64_t>(out, nodes.size());
+        for (auto node: nodes)
+        {
+            write_value<uint32_t>(out, Cudd_NodeReadIndex(node));
+            write_value<uint64_t>(out, ref(Cudd_T(node)));
+            write_value<uint64_t>(out, ref(Cudd_E(node)));
+        }
+
+        write_value<uint32_t>(out, (uint32_t) roots.size());
+        for (const auto& [name, r]: roots)
+        {
+            write_string(out, name);
+            write_value<uint64_t>(out, r);
+        }
+        MASSERT(out, "could not write to " << tmp_file_name);
+    }
+    filesystem::rename(tmp_file_name, file_name);
+    spdlog::info("saved {} BDDs ({} nodes) to {}", roots.size(), nodes.size(), file_name);
+}
+
+
+optional<hmap<string, BDD>> sdf::load_bdds(const Cudd& cudd,
+                                           const string& file_name,
+                                           const vector<string>& names,
+                                           bool do_restore_order)
+{
+    ifstream in(file_name, ios::binary);
+    if (!in)
+        return nullopt;
+
+    string magic(MAGIC.size(), '\0');
+    in.read(magic.data(), (streamsize) magic.size());
+    MASSERT(in && magic == MAGIC, file_name << " is not a BDD file");
+
+    // the variables
+    auto nof_vars = read_value<uint32_t>(in);
+    vector<pair<int32_t, uint32_t>> saved_level_and_index;
+    for (uint32_t i = 0; i < nof_vars; ++i)
+    {
+        auto name = read_string(in);
+        auto level = read_value<int32_t>(in);
+        if ((int) i >= cudd.ReadSize() || cudd.getVariableName(i) != name)
+        {
+            spdlog::warn("{}: the variable {} is {}, which is not the variable of this game", file_name, i, name);
+            return nullopt;
+        }
+        saved_level_and_index.emplace_back(level, i);
+    }
+
+    // the nodes and the roots are read before any node is built: only the nodes of the requested roots are built
+    struct SavedNode
+    {
+        uint32_t index;
+        uint64_t then_ref;
+        uint64_t else_ref;
+    };
+    auto nof_nodes = read_value<uint64_t>(in);
+    vector<SavedNode> saved_nodes(nof_nodes);
+    for (auto& node: saved_nodes)
+    {
+        node.index = read_value<uint32_t>(in);
+        node.then_ref = read_value<uint64_t>(in);
+        node.else_ref = read_value<uint64_t>(in);
+        MASSERT(node.index < nof_vars, file_name << " is corrupted");
+    }
+    vector<pair<string, uint64_t>> roots;
+    auto nof_roots = read_value<uint32_t>(in);
+    for (uint32_t r = 0; r < nof_roots; ++r)
+    {
+        auto name = read_string(in);
+        auto ref = read_value<uint64_t>(in);
+        if (names.empty() || find(names.begin(), names.end(), name) != names.end())
+            roots.emplace_back(name, ref);
+    }
+
+    vector<bool> is_needed(nof_nodes + 1, false);  // (by id, the children have smaller ids)
+    for (const auto& [name, ref]: roots)
+    {
+        MASSERT((ref >> 1) <= nof_nodes, file_name << " is corrupted");
+        is_needed[ref >> 1] = true;
+    }
+    for (auto id = nof_nodes; id > 0; --id)
+        if (is_needed[id])
+        {
+            const auto& node = saved_nodes[id - 1];
+            MASSERT((node.then_ref >> 1) < id && (node.else_ref >> 1) < id, file_name << " is corrupted");
+            is_needed[node.then_ref >> 1] = is_needed[node.else_ref >> 1] = true;
+        }
+
+    // the variable order: the saved variables as saved, then the others as they are
+    if (do_restore_order)
+    {
+        sort(saved_level_and_index.begin(), saved_level_and_index.end());
+        vector<int> order;
+        for (const auto& [level, index]: saved_level_and_index)
+            order.push_back((int) index);
+        vector<pair<int, int>> other_level_and_index;
+        for (int i = (int) nof_vars; i < cudd.ReadSize(); ++i)
+            other_level_and_index.emplace_back(cudd.ReadPerm(i), i);
+        sort(other_level_and_index.begin(), other_level_and_index.end());
+        for (const auto& [level, index]: other_level_and_index)
+            order.push_back(index);
+        if (!order.empty())
+            cudd.ShuffleHeap(order.data());
+    }
+
+    // the nodes
+    vector<BDD> nodes(nof_nodes + 1);
+    nodes[0] = cudd.bddOne();
+    auto deref = [&](uint64_t r)
+    {
+        return (r & 1) ? ~nodes[r >> 1] : nodes[r >> 1];
+    };
+    uint64_t nof_built = 0;
+    for (uint64_t id = 1; id <= nof_nodes; ++id)
+        if (is_needed[id])
+        {
+            const auto& node = saved_nodes[id - 1];
+            nodes[id] = cudd.ReadVars((int) node.index).Ite(deref(node.then_ref), deref(node.else_ref));
+            ++nof_built;
+        }
+
+    hmap<string, BDD> bdd_by_name;
+    for (const auto& [name, ref]: roots)
+        bdd_by_name[name] = deref(ref);
+
+    spdlog::info("loaded {} BDDs ({} nodes) from {}", bdd_by_name.size(), nof_built, file_name);
+    return bdd_by_name;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <mtr.h>  // mtr before cudd
+#include <cudd.h>
+#include <cuddObj.hh>
+
+
+namespace sdf
+{
+
+/**
+ * A binary dump of named BDDs of one manager (in the spirit of DDDMP):
+ * - the names of the variables up to the largest index in the support of the BDDs, and their levels (the variable order),
+ * - the shared DAG of the BDDs, the children before the parents, the arcs with the complement bit,
+ * - the roots by name.
+ * The file is meant to be read by the same binary on the same machine (the integers are dumped as they are in memory).
+ */
+void save_bdds(const Cudd& cudd,
+               const std::vector<std::pair<std::string, BDD>>& bdd_by_name,
+               const std::string& file_name);
+
+/**
+ * Loads the BDDs saved by save_bdds into `cudd`, which must have the same variables (by name) at the same indices.
+ * Only the BDDs in `names` are built (all of them if it is empty).
+ * If `do_restore_order`, first shuffles the variables into the saved order
+ * (the variables not in the file keep their relative order, below).
+ * @return the BDDs by name, or nullopt if the file does not exist or its variables differ from those of `cudd`
+ */
+std::optional<std::unordered_map<std::string, BDD>> load_bdds(const Cudd& cudd,
+                                                              const std::string& file_name,
+                                                              const std::vector<std::string>& names = {},
+                                                              bool do_restore_order = true);
+
+} //namespace sdf
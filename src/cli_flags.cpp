@@ -0,0 +1,140 @@
+#include "cli_flags.hpp"
+
+
+using namespace std;
+
+
+sdf::EngineFlags::EngineFlags(args::Group& parser) :
+    engine(parser,
+           "engine",
+           "game solver: "
+           "'symbolic' encodes automaton states with BDD variables, "
+           "'counters' is like 'symbolic' but encodes the visit counters in binary instead of k-reducing the automaton, "
+           "'explicit' keeps (macro-)states explicit and uses BDDs for the moves only "
+           "(good for automata with up to a few thousands states), "
+           "'local' is like 'explicit' but explores on-the-fly from the initial state and stops as soon as it is decided, "
+           "'antichain' works on the UCW without k-reduction and prunes the nodes dominated by losing ones, "
+           "'auto' chooses between 'symbolic' and 'antichain' for every k based on the automaton. "
+           "Default: symbolic.",
+           {'e', "engine"},
+           get_engine_by_name(),
+           SolverEngine::symbolic),
+    k_policy(parser,
+             "k-policy",
+             "how k bounds the SCCs: "
+             "'uniform' uses k for every SCC, "
+             "'balanced' uses k for the smallest SCC with rejecting states and lowers it for larger SCCs "
+             "(smaller safety automata, but can fail where 'uniform' succeeds), "
+             "'feedback' starts with the smallest k for every SCC and, when the environment wins, "
+             "raises the bounds of the SCCs whose counters got exhausted, up to the largest k "
+             "(only with the 'antichain' engine, which 'auto' then always chooses). "
+             "Default: uniform.",
+             {"k-policy"},
+             get_k_policy_by_name(),
+             KBoundPolicy::uniform),
+    k_list(parser,
+           "k",
+           "the maximum number of times the same bad state can be visited "
+           "(thus, it is reset between SCCs). "
+           "If you provide it several times (e.g. -k 1 -k 4 -k 8), then I will try all those values in that order. "
+           "Default: 4.",
+           {'k'},
+           {4})
+{
+}
+
+
+void sdf::EngineFlags::validate()
+{
+    if (k_policy.Get() == KBoundPolicy::feedback &&
+        engine.Get() != SolverEngine::antichain && engine.Get() != SolverEngine::automatic)
+        throw args::ValidationError("--k-policy feedback needs --engine antichain (or auto)");
+}
+
+
+sdf::TuningFlags::TuningFlags(args::Group& parser) :
+    extract_method(parser,
+                   "extract",
+                   "how the output functions are extracted from the strategy: "
+                   "'abstraction' quantifies away the variables an output does not depend on (slow on large specs), "
+                   "'squeeze', 'li-compaction', 'isop', 'restrict', 'constrain' use the CUDD operation of that name with the don't-cares, "
+                   "'best' tries all of them for every output (each for at most " + to_string(EXTRACT_TRY_SEC) + " sec) and keeps the smallest. "
+                   "Default: abstraction.",
+                   {"extract"},
+                   get_extract_method_by_name(),
+                   ExtractMethod::abstraction),
+    extract_order(parser,
+                  "extract-order",
+                  "the order in which the outputs are concretised (it substantially affects the circuit size): "
+                  "'fixed' is the reverse order of the outputs, "
+                  "'greedy' takes the output with the smallest function first (extracting every remaining output at every step), "
+                  "'search' tries fixed, reversed, and greedy within " + to_string(EXTRACT_ORDER_SEC) + " sec and keeps the smallest model. "
+                  "Default: fixed.",
+                  {"extract-order"},
+                  get_extract_order_by_name(),
+                  ExtractOrder::fixed),
+    anytime(parser,
+            "anytime",
+            "extract a cheap model first, then improve it (as requested by the other options) "
+            "while solving the final game takes less than this many seconds, and keep the smaller circuit "
+            "(0 means no anytime extraction). "
+            "Default: 0.",
+            {"anytime"},
+            0),
+    no_signal_pruning(parser,
+                      "no-signal-pruning",
+                      "keep all the signals in the game: by default, the signals the winner does not need "
+                      "(e.g., those the formula does not mention) are dropped and put back into the model as free inputs or constant outputs",
+                      {"no-signal-pruning"}),
+    memory(parser,
+           "memory",
+           "the memory ceiling of the BDD library in MB (0 means none): "
+           "when the extraction gets close to it (or runs out of memory in the greedy or search order), "
+           "it drops the reachability optimization, collects the garbage, reorders, and uses the squeeze extraction; "
+           "when a game runs out of memory, smaller k are tried. "
+           "Default: 0.",
+           {"memory"},
+           0),
+    reorder(parser,
+            "reorder",
+            "the dynamic reordering of BDD variables: "
+            "'off', "
+            "'sift' sifts while solving (but not while extracting the model) and once more before building the circuit, "
+            "'adaptive' switches between sift, group sift, and window reordering based on the node savings, "
+            "time-boxes the passes, and stops reordering once it does not pay off. "
+            "Default: sift.",
+            {"reorder"},
+            get_reorder_policy_by_name(),
+            ReorderPolicy::sift),
+    checkpoint(parser,
+               "checkpoint",
+               "save the winning region and the strategy (as BDDs) to this file as soon as they are computed, "
+               "and the output functions to the file of the same name with the suffix .outputs",
+               {"checkpoint"}),
+    resume(parser,
+           "resume",
+           "start from the checkpoint file if it is of the same game (same spec and k; not with the explicit engines): "
+           "skip the solving, and also the extraction unless --re-extract",
+           {"resume"}),
+    re_extract(parser,
+               "re-extract",
+               "when resuming, extract the output functions anew (e.g., with other extraction options)",
+               {"re-extract"})
+{
+}
+
+
+sdf::SolverTuning sdf::TuningFlags::get_tuning()
+{
+    SolverTuning tuning;
+    tuning.extract_method = extract_method.Get();
+    tuning.extract_order = extract_order.Get();
+    tuning.anytime_sec = anytime.Get();
+    tuning.memory_mb = memory.Get();
+    tuning.prune_signals = !no_signal_pruning.Get();
+    tuning.reorder_policy = reorder.Get();
+    tuning.checkpoint_file = checkpoint ? checkpoint.Get() : "";
+    tuning.resume = resume.Get();
+    tuning.re_extract = re_extract.Get();
+    return tuning;
+}
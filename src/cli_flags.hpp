@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+#include <args.hxx>
+
+#include "synthesizer.hpp"
+#include "solver_tuning.hpp"
+
+
+namespace sdf
+{
+
+/** the command-line flags of the game solver, shared by sdf-tlsf, sdf-hoa and sdf-batch */
+struct EngineFlags
+{
+    args::MapFlag<std::string, SolverEngine> engine;
+    args::MapFlag<std::string, KBoundPolicy> k_policy;
+    args::ValueFlagList<uint> k_list;
+
+    explicit EngineFlags(args::Group& parser);
+
+    /** (call after parsing) throws args::ValidationError for the combinations the solver rejects */
+    void validate();
+};
+
+/** the command-line flags of SolverTuning, shared by sdf-tlsf, sdf-hoa and sdf-batch */
+struct TuningFlags
+{
+    args::MapFlag<std::string, ExtractMethod> extract_method;
+    args::MapFlag<std::string, ExtractOrder> extract_order;
+    args::ValueFlag<uint> anytime;
+    args::Flag no_signal_pruning;
+    args::ValueFlag<uint> memory;
+    args::MapFlag<std::string, ReorderPolicy> reorder;
+    args::ValueFlag<std::string> checkpoint;
+    args::Flag resume;
+    args::Flag re_extract;
+
+    explicit TuningFlags(args::Group& parser);
+
+    /** (call after parsing) */
+    SolverTuning get_tuning();
+};
+
+} //namespace sdf
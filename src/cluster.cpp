@@ -0,0 +1,495 @@
+#include "cluster.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <netdb.h>
+#include <poll.h>
+#include <set>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "syntcomp_constants.hpp"
+#include "utils.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+using Clock = chrono::steady_clock;
+
+
+namespace
+{
+
+struct Message
+{
+    string tag;
+    ulong number;
+    string payload;
+};
+
+/** A connection with its partially received messages */
+struct Peer
+{
+    int fd;
+    string buffer;
+    uint nof_workers = 0;  // (coordinator side: 0 until HELLO)
+    set<ulong> jobs;       // (coordinator side: the jobs sent and not yet answered)
+};
+
+}
+
+
+/* ------------------------------- sockets -------------------------------- */
+
+/** @return (host, port) for `host:port`, or (path, "") for `unix:path` */
+static pair<string, string> parse_address(const string& address)
+{
+    if (address.rfind("unix:", 0) == 0)
+        return {address.substr(5), ""};
+    auto colon = address.rfind(':');
+    MASSERT(colon != string::npos, "expected host:port or unix:path, got: " << address);
+    return {address.substr(0, colon), address.substr(colon + 1)};
+}
+
+
+static int open_unix_socket(const string& path, bool do_listen)
+{
+    sockaddr_un addr{};
+    MASSERT(path.size() < sizeof(addr.sun_path), "the socket path is too long: " << path);
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    MASSERT(fd >= 0, "could not create a socket");
+    if (do_listen)
+    {
+        unlink(path.c_str());  // (a stale socket of a previous run)
+        MASSERT(bind(fd, (sockaddr*) &addr, sizeof(addr)) == 0 && listen(fd, 64) == 0,
+                "could not listen on " << path << ": " << strerror(errno));
+        return fd;
+    }
+    if (connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+static int open_tcp_socket(const string& host, const string& port, bool do_listen)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = do_listen ? AI_PASSIVE : 0;
+    addrinfo* infos = nullptr;
+    int rc = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &infos);
+    MASSERT(rc == 0, "could not resolve " << host << ":" << port << ": " << gai_strerror(rc));
+
+    int fd = -1;
+    for (auto info = infos; info != nullptr && fd < 0; info = info->ai_next)
+    {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0)
+            continue;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        bool is_ok = do_listen
+                     ? bind(fd, info->ai_addr, info->ai_addrlen) == 0 && listen(fd, 64) == 0
+                     : connect(fd, info->ai_addr, info->ai_addrlen) == 0;
+        if (!is_ok)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(infos);
+    return fd;
+}
+
+
+static int open_socket(const string& address, bool do_listen)
+{
+    auto [host_or_path, port] = parse_address(address);
+    return port.empty() ? open_unix_socket(host_or_path, do_listen) : open_tcp_socket(host_or_path, port, do_listen);
+}
+
+
+/* ------------------------------- messages ------------------------------- */
+
+static bool send_message(int fd, const string& tag, ulong number, const string& payload = "")
+{
+    auto data = tag + " " + to_string(number) + " " + to_string(payload.size()) + "\n" + payload;
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        written += n;
+    }
+    return true;
+}
+
+
+/** @return false iff the peer closed the connection (or it broke) */
+static bool receive(Peer& peer)
+{
+    char chunk[1 << 16];
+    while (true)
+    {
+        auto n = read(peer.fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        peer.buffer.append(chunk, n);
+        return true;
+    }
+}
+
+
+/** @return the complete messages received so far (they are removed from the buffer) */
+static vector<Message> pop_messages(Peer& peer)
+{
+    vector<Message> messages;
+    size_t pos = 0;
+    while (true)
+    {
+        auto eol = peer.buffer.find('\n', pos);
+        if (eol == string::npos)
+            break;
+        auto header = split_by_space(peer.buffer.substr(pos, eol - pos));
+        MASSERT(header.size() == 3, "unexpected message header: " << peer.buffer.substr(pos, eol - pos));
+        auto length = (size_t) stoul(header[2]);
+        if (eol + 1 + length > peer.buffer.size())
+            break;  // (not yet complete)
+        messages.push_back({header[0], stoul(header[1]), peer.buffer.substr(eol + 1, length)});
+        pos = eol + 1 + length;
+    }
+    peer.buffer.erase(0, pos);
+    return messages;
+}
+
+
+/* -------------------------------- config -------------------------------- */
+
+template<typename T>
+static string name_of(const unordered_map<string, T>& by_name, T value)
+{
+    for (const auto& [name, v]: by_name)
+        if (v == value)
+            return name;
+    UNREACHABLE();
+}
+
+
+static string encode_config(const BatchDescr& batch_descr)
+{
+    stringstream ss;
+    ss << "k: " << join(" ", batch_descr.k_to_iterate) << "\n"
+       << "engine: " << name_of(get_engine_by_name(), batch_descr.engine) << "\n"
+       << "k-policy: " << name_of(get_k_policy_by_name(), batch_descr.k_policy) << "\n"
+       << "ra: " << batch_descr.do_reach_optim << "\n"
+       << "translation-level: " << name_of(get_translation_level_by_name(), batch_descr.tuning.translation_level) << "\n"
+       << "extract: " << name_of(get_extract_method_by_name(), batch_descr.tuning.extract_method) << "\n"
+       << "extract-order: " << name_of(get_extract_order_by_name(), batch_descr.tuning.extract_order) << "\n"
+       << "reorder: " << name_of(get_reorder_policy_by_name(), batch_descr.tuning.reorder_policy) << "\n"
+       << "reorder-in-extraction: " << batch_descr.tuning.reorder_in_extraction << "\n"
+       << "memory: " << batch_descr.tuning.memory_mb << "\n"
+       << "anytime: " << batch_descr.tuning.anytime_sec << "\n"
+       << "signal-pruning: " << batch_descr.tuning.prune_signals << "\n"
+       << "deadline: " << batch_descr.deadline_sec << "\n"
+       << "timeout: " << batch_descr.timeout_sec << "\n"
+       << "dual: " << batch_descr.check_unreal << "\n"
+       << "circuit: " << batch_descr.extract_model << "\n";
+    return ss.str();
+}
+
+
+static BatchDescr decode_config(const string& config, uint nof_workers)
+{
+    BatchDescr batch_descr;
+    batch_descr.nof_workers = nof_workers;
+    stringstream ss(config);
+    for (string line; getline(ss, line); )
+    {
+        auto colon = line.find(':');
+        MASSERT(colon != string::npos, "unexpected config line: " << line);
+        auto key = line.substr(0, colon);
+        auto value = trim_spaces(line.substr(colon + 1));
+        if (key == "k")
+        {
+            batch_descr.k_to_iterate.clear();
+            for (const auto& k: split_by_space(value))
+                batch_descr.k_to_iterate.push_back(stoul(k));
+        }
+        else if (key == "engine")
+            batch_descr.engine = get_engine_by_name().at(value);
+        else if (key == "k-policy")
+            batch_descr.k_policy = get_k_policy_by_name().at(value);
+        else if (key == "ra")
+            batch_descr.do_reach_optim = value == "1";
+        else if (key == "translation-level")
+            batch_descr.tuning.translation_level = get_translation_level_by_name().at(value);
+        else if (key == "extract")
+            batch_descr.tuning.extract_method = get_extract_method_by_name().at(value);
+        else if (key == "extract-order")
+            batch_descr.tuning.extract_order = get_extract_order_by_name().at(value);
+        else if (key == "reorder")
+            batch_descr.tuning.reorder_policy = get_reorder_policy_by_name().at(value);
+        else if (key == "reorder-in-extraction")
+            batch_descr.tuning.reorder_in_extraction = value == "1";
+        else if (key == "memory")
+            batch_descr.tuning.memory_mb = stoul(value);
+        else if (key == "anytime")
+            batch_descr.tuning.anytime_sec = stoul(value);
+        else if (key == "signal-pruning")
+            batch_descr.tuning.prune_signals = value == "1";
+        else if (key == "deadline")
+            batch_descr.deadline_sec = stoul(value);
+        else if (key == "timeout")
+            batch_descr.timeout_sec = stoul(value);
+        else if (key == "dual")
+            batch_descr.check_unreal = value == "1";
+        else if (key == "circuit")
+            batch_descr.extract_model = value == "1";
+        else
+            MASSERT(0, "unknown config key: " << key);
+    }
+    return batch_descr;
+}
+
+
+/** @return the value of the (non-nested) field of the result line, without quotes; empty if missing */
+static string get_field(const string& json_line, const string& key)
+{
+    auto pos = json_line.find("\"" + key + "\": ");
+    if (pos == string::npos)
+        return "";
+    pos += key.size() + 4;
+    if (json_line[pos] == '"')
+        return json_line.substr(pos + 1, json_line.find('"', pos + 1) - pos - 1);
+    return json_line.substr(pos, json_line.find_first_of(",}", pos) - pos);
+}
+
+
+/* ------------------------------ coordinator ------------------------------ */
+
+int sdf::run_coordinator(const BatchDescr& batch_descr, const string& address)
+{
+    const auto& files = batch_descr.spec_files;
+    auto start = Clock::now();
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = open_socket(address, true);
+    MASSERT(listen_fd >= 0, "could not listen on " << address);
+    spdlog::info("coordinator: listening on {}, {} specs", address, files.size());
+
+    deque<ulong> queue;
+    for (ulong idx = 0; idx < files.size(); ++idx)
+        queue.push_back(idx);
+    vector<uint> nof_attempts(files.size(), 0);
+    vector<bool> is_done(files.size(), false);
+    ulong nof_done = 0;
+
+    map<string, uint> nof_by_verdict = {{SYNTCOMP_STR_REAL, 0}, {SYNTCOMP_STR_UNREAL, 0}, {SYNTCOMP_STR_UNKNOWN, 0},
+                                        {"TIMEOUT", 0}, {"ERROR", 0}};
+    uint nof_nodes = 0, nof_reassigned = 0;
+    double solving_sec = 0;
+    auto report = [&](ulong idx, const string& line)
+    {
+        cout << line << endl;
+        is_done[idx] = true;
+        ++nof_done;
+        nof_by_verdict[get_field(line, "verdict")]++;
+        if (auto sec = get_field(line, "solving_sec"); !sec.empty())
+            solving_sec += stod(sec);
+    };
+
+    vector<Peer> nodes;
+    auto drop_node = [&](size_t n)
+    {
+        spdlog::info("coordinator: a node disconnected, {} specs to reassign", nodes[n].jobs.size());
+        for (auto idx: nodes[n].jobs)
+        {
+            if (is_done[idx])
+                continue;
+            if (nof_attempts[idx] >= MAX_ATTEMPTS)
+            {
+                report(idx, make_error_result(files[idx], "ERROR", "the nodes solving it failed " + to_string(MAX_ATTEMPTS) + " times"));
+                continue;
+            }
+            queue.push_front(idx);
+            ++nof_reassigned;
+        }
+        close(nodes[n].fd);
+        nodes.erase(nodes.begin() + (long) n);
+    };
+
+    while (nof_done < files.size())
+    {
+        // keep every worker of every node busy
+        for (size_t n = 0; n < nodes.size(); ++n)
+            while (!queue.empty() && nodes[n].jobs.size() < nodes[n].nof_workers)
+            {
+                auto idx = queue.front();
+                queue.pop_front();
+                ifstream file(files[idx]);
+                if (!file)
+                {
+                    report(idx, make_error_result(files[idx], "ERROR", "cannot read the file"));
+                    continue;
+                }
+                stringstream text;
+                text << file.rdbuf();
+                ++nof_attempts[idx];
+                nodes[n].jobs.insert(idx);
+                if (!send_message(nodes[n].fd, "JOB", idx, files[idx] + "\n" + text.str()))
+                    break;  // (the disconnection is noticed below)
+            }
+
+        vector<pollfd> fds = {{listen_fd, POLLIN, 0}};
+        for (const auto& node: nodes)
+            fds.push_back({node.fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            MASSERT(errno == EINTR, "poll failed");
+            continue;
+        }
+
+        for (size_t n = nodes.size(); n-- > 0; )
+        {
+            if (!(fds[n+1].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            if (!receive(nodes[n]))
+            {
+                drop_node(n);
+                continue;
+            }
+            for (const auto& message: pop_messages(nodes[n]))
+                if (message.tag == "HELLO")
+                {
+                    nodes[n].nof_workers = message.number;
+                    ++nof_nodes;
+                    spdlog::info("coordinator: a node with {} workers joined", message.number);
+                    send_message(nodes[n].fd, "CONFIG", 0, encode_config(batch_descr));
+                }
+                else if (message.tag == "RESULT")
+                {
+                    nodes[n].jobs.erase(message.number);
+                    if (message.number < files.size() && !is_done[message.number])
+                        report(message.number, message.payload);
+                }
+                else
+                    MASSERT(0, "unexpected message from a node: " << message.tag);
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0)
+                nodes.push_back({fd, "", 0, {}});
+        }
+    }
+
+    for (const auto& node: nodes)
+        close(node.fd);  // (the nodes exit)
+    close(listen_fd);
+    if (auto [path, port] = parse_address(address); port.empty())
+        unlink(path.c_str());
+
+    stringstream summary;
+    summary << "{\"summary\": {\"specs\": " << files.size();
+    for (const auto& [verdict, count]: nof_by_verdict)
+        summary << ", \"" << verdict << "\": " << count;
+    summary << ", \"nodes\": " << nof_nodes << ", \"reassigned\": " << nof_reassigned
+            << ", \"solving_sec\": " << solving_sec
+            << ", \"wall_sec\": " << chrono::duration<double>(Clock::now() - start).count() << "}}";
+    cout << summary.str() << endl;
+
+    return (nof_by_verdict["TIMEOUT"] + nof_by_verdict["ERROR"] == 0) ? 0 : 1;
+}
+
+
+/* --------------------------------- node --------------------------------- */
+
+int sdf::run_node(const string& address, uint nof_workers)
+{
+    MASSERT(nof_workers > 0, "the number of workers must be positive");
+    signal(SIGPIPE, SIG_IGN);
+
+    Peer coordinator{-1, "", 0, {}};
+    for (uint attempt = 0; (coordinator.fd = open_socket(address, false)) < 0; ++attempt)
+    {
+        MASSERT(attempt < 100, "could not connect to the coordinator at " << address);
+        usleep(100000);  // (the coordinator is starting)
+    }
+    MASSERT(send_message(coordinator.fd, "HELLO", nof_workers), "could not greet the coordinator");
+
+    optional<BatchDescr> batch_descr;
+    while (!batch_descr)
+    {
+        if (!receive(coordinator))
+            return 1;
+        for (const auto& message: pop_messages(coordinator))
+        {
+            MASSERT(message.tag == "CONFIG", "expected the config, got: " << message.tag);
+            batch_descr = decode_config(message.payload, nof_workers);
+        }
+    }
+    spdlog::info("node: connected to {}, {} workers", address, nof_workers);
+
+    WorkerPool pool(*batch_descr);
+    pool.close_in_workers(coordinator.fd);
+
+    deque<Message> jobs;  // (received but not yet started)
+    bool is_connected = true;
+    while (is_connected)
+    {
+        while (!jobs.empty() && pool.get_nof_idle() > 0)
+        {
+            const auto& job = jobs.front();
+            auto eol = job.payload.find('\n');
+            pool.submit(job.number, job.payload.substr(0, eol), job.payload.substr(eol + 1));
+            jobs.pop_front();
+        }
+
+        auto fds = pool.get_poll_fds();
+        fds.push_back({coordinator.fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), pool.get_poll_timeout_ms()) < 0)
+            MASSERT(errno == EINTR, "poll failed");
+
+        if (fds.back().revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            is_connected = receive(coordinator);
+            for (auto& message: pop_messages(coordinator))
+            {
+                MASSERT(message.tag == "JOB", "unexpected message from the coordinator: " << message.tag);
+                jobs.push_back(move(message));
+            }
+        }
+
+        for (const auto& [job_id, line]: pool.collect())
+            if (!send_message(coordinator.fd, "RESULT", job_id, line))
+                is_connected = false;
+    }
+
+    spdlog::info("node: the coordinator closed the connection");
+    close(coordinator.fd);
+    return 0;  // (the pool stops its workers)
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+#include "batch.hpp"
+
+
+namespace sdf
+{
+
+/**
+ * Distribution of the batch over several nodes (hosts or local processes).
+ *
+ * The coordinator listens on `address`, the nodes connect to it and announce their number of workers;
+ * the coordinator sends them its options and then the specs (as text, so the nodes need no shared file system),
+ * keeping every worker of every node busy.
+ * A node solves the specs on its WorkerPool (so the per-spec deadline and timeout work as in the batch mode)
+ * and sends back the result lines.
+ * When a node disconnects, its unfinished specs are given to other nodes (at most MAX_ATTEMPTS times per spec).
+ *
+ * Addresses: `host:port` (TCP; for the coordinator, the host can be omitted: `:port`) or `unix:path` (Unix domain socket).
+ *
+ * Messages (both directions): `<tag> <number> <payload length>\n<payload>`:
+ *   node -> coordinator:  HELLO <number of workers> 0,  RESULT <job> <result line>
+ *   coordinator -> node:  CONFIG 0 <`key: value` lines>,  JOB <job> <spec name>\n<spec text>
+ */
+
+const uint MAX_ATTEMPTS = 3;
+
+/**
+ * Print the result lines as they arrive (as run_batch does), then one summary line:
+ *
+ *     {"summary": {"specs": 100, "ERROR": 1, "REALIZABLE": 60, "TIMEOUT": 1, "UNKNOWN": 38, "UNREALIZABLE": 0,
+ *                  "nodes": 3, "reassigned": 2, "solving_sec": 123.4, "wall_sec": 45.6}}
+ *
+ * (BatchDescr::nof_workers and BatchDescr::output_dir are not used: the nodes have their own.)
+ * @return 0 iff no spec ended with ERROR or TIMEOUT
+ */
+int run_coordinator(const BatchDescr& batch_descr, const std::string& address);
+
+/**
+ * Connect to the coordinator and solve the specs it sends, using `nof_workers` workers,
+ * until the coordinator closes the connection.
+ */
+int run_node(const std::string& address, uint nof_workers);
+
+} //namespace sdf
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+
+#define BDD spotBDD
+    #include <spot/twa/twagraph.hh>
+    #include <spot/twaalgos/sccinfo.hh>
+#undef BDD
+
+
+#include "counter_game_solver.hpp"
+#include "atm_helper.hpp"
+#include "utils.hpp"
+
+
+using namespace std;
+
+
+#define hmap unordered_map
+
+
+sdf::CounterGameSolver::CounterGameSolver(bool is_moore_,
+                                          const std::unordered_set<spot::formula>& inputs_,
+                                          const std::unordered_set<spot::formula>& outputs_,
+                                          const spot::twa_graph_ptr& ucw_,  // NOLINT(*-pass-by-value)
+                                          const std::vector<uint>& k_by_scc_,
+                                          const bool do_reach_optim,
+                                          uint time_limit_sec_) :
+    GameSolver(is_moore_, inputs_, outputs_, ucw_, do_reach_optim, time_limit_sec_),
+    k_by_scc(k_by_scc_),
+    max_k(*max_element(k_by_scc_.begin(), k_by_scc_.end()))
+{
+    MASSERT(aut->is_sba().is_true(), "currently, only SBA is supported");
+
+    spot::scc_info scc_info(aut);
+    MASSERT(k_by_scc.size() == scc_info.scc_count(), "the bounds must be given for every SCC");
+    vector<bool> scc_has_rejecting(scc_info.scc_count(), false);
+    for (uint q = 0; q < aut->num_states(); ++q)
+    {
+        scc_of.push_back(scc_info.scc_of(q));
+        is_sink.push_back(is_acc_sink(aut, q));
+        if (aut->state_is_accepting(q) && !is_sink.back() && !scc_info.is_trivial(scc_of.back()))
+            scc_has_rejecting[scc_of.back()] = true;
+    }
+    for (uint q = 0; q < aut->num_states(); ++q)
+        has_budget.push_back(!is_sink[q] && scc_has_rejecting[scc_of[q]]);
+}
+
+
+void sdf::CounterGameSolver::declare_state_vars()
+{
+    // the latches occupy the cudd indices NOF_SIGNALS, NOF_SIGNALS+1, ... without gaps
+    MASSERT((uint)cudd.ReadSize() == NOF_SIGNALS, "signal variables must be declared first");
+
+    auto declare = [&](const string& name)
+    {
+        uint cuddIdx = cudd.ReadSize();
+        cudd.bddVar((int)cuddIdx);
+        cudd.pushVariableName(name);
+        return cuddIdx;
+    };
+
+    active_idx.assign(aut->num_states(), 0);
+    budget_idx.assign(aut->num_states(), {});
+    for (uint q = 0; q < aut->num_states(); ++q)
+    {
+        if (is_sink[q])
+            continue;
+        active_idx[q] = declare("s" + to_string(q));
+        if (has_budget[q])
+            for (uint b = 0; b < get_nof_bits(k_by_scc[scc_of[q]]); ++b)
+                budget_idx[q].push_back(declare("s" + to_string(q) + "c" + to_string(b)));
+    }
+    error_idx = declare("err");
+
+    spdlog::info("declare_state_vars: {} latches for {} automaton states and k by SCC = {}",
+                 cudd.ReadSize() - NOF_SIGNALS, aut->num_states(), join(", ", k_by_scc));
+}
+
+
+uint sdf::CounterGameSolver::get_nof_bits(uint k)
+{
+    uint nof_bits = 0;
+    while ((1ul << nof_bits) <= k)
+        ++nof_bits;
+    return nof_bits;
+}
+
+
+vector<BDD> sdf::CounterGameSolver::get_budget_vars(uint q)
+{
+    vector<BDD> bits;
+    for (auto idx: budget_idx[q])
+        bits.push_back(cudd.ReadVars((int)idx));
+    return bits;
+}
+
+
+BDD sdf::CounterGameSolver::less_or_equal(const vector<BDD>& bits, int c)
+{
+    if (c < 0)
+        return cudd.bddZero();
+    if ((ulong)c >= (1ul << bits.size()))
+        return cudd.bddOne();
+
+    // from the least significant bit: result = `value(bits[0..b]) <= c[0..b]`
+    BDD result = cudd.bddOne();
+    for (uint b = 0; b < bits.size(); ++b)
+        result = (c >> b) & 1 ? ~bits[b] | result : ~bits[b] & result;
+    return result;
+}
+
+
+void sdf::CounterGameSolver::build_error_bdd()
+{
+    spdlog::info("build_error_bdd..");
+    error = cudd.ReadVars((int)error_idx);
+}
+
+
+void sdf::CounterGameSolver::build_init_state_bdd()
+{
+    spdlog::info("build_init_state_bdd..");
+
+    // the initial state is active with the budget k (of its SCC), the others are inactive with the budget 0
+    auto q0 = aut->get_init_state_number();
+    auto k0 = k_by_scc[scc_of[q0]];
+    init_latches.clear();
+    if (is_sink[q0])
+        init_latches.push_back(error_idx);
+    else
+    {
+        init_latches.push_back(active_idx[q0]);
+        for (uint b = 0; b < budget_idx[q0].size(); ++b)
+            if ((k0 >> b) & 1)
+                init_latches.push_back(budget_idx[q0][b]);
+    }
+
+    init = cudd.bddOne();
+    for (uint cuddIdx = NOF_SIGNALS; cuddIdx < (uint)cudd.ReadSize(); ++cuddIdx)
+        init &= contains(init_latches, cuddIdx) ? cudd.ReadVars((int)cuddIdx) : ~cudd.ReadVars((int)cuddIdx);
+}
+
+
+void sdf::CounterGameSolver::build_pre_trans_func()
+{
+    /**
+     * For the edge p -> q (label l), the budget of q is
+     * - budget(p) - acc(p) if p and q are in the same SCC, and it is an error when the result is -1;
+     * - k (of the SCC of q) otherwise.
+     * Entering an accepting sink is an error.
+     * The budget of q is the minimum over the active incoming edges:
+     *     at_most(v) = OR_{p,l} active(p) & l & `the new budget is <= v`,
+     *     budget'(q) = v such that at_most(v) & !at_most(v-1).
+     */
+
+    spdlog::info("build_pre_trans_func..");
+
+    hmap<uint, vector<pair<uint, BDD>>> in_edges_by_state;  // q -> (p, active(p) & label)
+    BDD error_next = error;  // (the error is sticky, as the accepting sink of the k-reduced automaton)
+    for (uint p = 0; p < aut->num_states(); ++p)
+    {
+        if (is_sink[p])
+            continue;
+        BDD p_var = cudd.ReadVars((int)active_idx[p]);
+        BDD p_exhausted = less_or_equal(get_budget_vars(p), 0);
+        for (const auto& t: aut->out(p))
+        {
+            BDD p_label = p_var & translate_label(t.cond);
+            if (is_sink[t.dst])
+                error_next |= p_label;
+            else if (scc_of[p] == scc_of[t.dst] && aut->state_is_accepting(p))
+                error_next |= p_label & p_exhausted;
+            if (!is_sink[t.dst])
+                in_edges_by_state[t.dst].emplace_back(p, p_label);
+        }
+    }
+    pre_trans_func[error_idx] = error_next;
+
+    for (uint q = 0; q < aut->num_states(); ++q)
+    {
+        if (is_sink[q])
+            continue;
+
+        // the budget of q after the edge is at most v
+        auto at_most = [&](int v)
+        {
+            BDD result = cudd.bddZero();
+            for (const auto& [p, p_label]: in_edges_by_state[q])
+            {
+                if (scc_of[p] != scc_of[q])
+                    result |= (v >= (int)k_by_scc[scc_of[q]]) ? p_label : cudd.bddZero();
+                else if (aut->state_is_accepting(p))  // budget(p) - 1 <= v, and not an error
+                    result |= p_label & ~less_or_equal(get_budget_vars(p), 0) & less_or_equal(get_budget_vars(p), v+1);
+                else
+                    result |= p_label & less_or_equal(get_budget_vars(p), v);
+            }
+            return result;
+        };
+
+        pre_trans_func[active_idx[q]] = at_most((int)max_k);
+
+        if (!has_budget[q])
+            continue;
+
+        auto nof_bits = budget_idx[q].size();
+        vector<BDD> bits_next(nof_bits, cudd.bddZero());
+        BDD prev = cudd.bddZero();
+        for (uint v = 0; v <= k_by_scc[scc_of[q]]; ++v)
+        {
+            BDD curr = at_most((int)v);
+            BDD is_min = curr & ~prev;
+            for (uint b = 0; b < nof_bits; ++b)
+                if ((v >> b) & 1)
+                    bits_next[b] |= is_min;
+            prev = curr;
+        }
+        for (uint b = 0; b < nof_bits; ++b)
+            pre_trans_func[budget_idx[q][b]] = bits_next[b];
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "game_solver.hpp"
+
+
+namespace sdf
+{
+
+/**
+ * Symbolic solver for the k-co-Büchi game that works on the UCW (no k-reduction):
+ * the visit counters are encoded in binary with latches,
+ * so the number of latches grows with log(k) rather than with k.
+ *
+ * Latches:
+ * - for every UCW state q (except accepting sinks): `q is active`;
+ * - for every state q of an SCC with rejecting states: the budget of q (ceil(log2(k+1)) latches, k is the bound of the SCC),
+ *   i.e. the number of visits to rejecting states the runs in q can still afford.
+ *   Runs of a universal automaton are independent, hence the budgets are per state rather than per SCC;
+ *   of several runs in q, only the one with the smallest budget matters (the others behave the same but fail later).
+ *   The other states do not need a budget: entering their SCC resets the budget to k, and it never decreases there.
+ * - one error latch (as the accepting sink of the k-reduced automaton).
+ * The budget decrement and reset are as in k_reduce, but are encoded in pre_trans_func.
+ */
+class CounterGameSolver : public GameSolver
+{
+
+public:
+    CounterGameSolver(bool is_moore_,
+                      const std::unordered_set<spot::formula>& inputs_,
+                      const std::unordered_set<spot::formula>& outputs_,
+                      const spot::twa_graph_ptr& ucw_,  // NOLINT(*-pass-by-value)
+                      const std::vector<uint>& k_by_scc_,  // the bound for every SCC (see k_reduce)
+                      const bool do_reach_optim,
+                      uint time_limit_sec_ = 3600);
+
+protected:
+    const std::vector<uint> k_by_scc;
+    const uint max_k;
+
+    std::vector<uint> scc_of;                   // UCW state -> SCC
+    std::vector<bool> is_sink;                  // UCW state -> is accepting sink?
+    std::vector<bool> has_budget;               // UCW state -> does the state need the budget?
+
+    std::vector<uint> active_idx;               // UCW state -> cudd index of `is active` (undefined for sinks)
+    std::vector<std::vector<uint>> budget_idx;  // UCW state -> cudd indices of its budget bits (least significant first)
+    uint error_idx = 0;
+
+protected:
+    void declare_state_vars() override;
+
+    void build_error_bdd() override;
+
+    void build_init_state_bdd() override;
+
+    void build_pre_trans_func() override;
+
+    /** (the latches encode the budgets, not the automaton states) */
+    std::optional<BDD> compute_reachable_explicitly() override { return std::nullopt; }
+
+    std::vector<BDD> get_budget_vars(uint q);
+
+    /** @return the number of bits needed to encode 0..k */
+    static uint get_nof_bits(uint k);
+
+    /** @return BDD of `value(bits) <= c` */
+    BDD less_or_equal(const std::vector<BDD>& bits, int c);
+};
+
+
+} // namespace sdf
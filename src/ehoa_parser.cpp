@@ -5,6 +5,11 @@
 #include <algorithm>
 #include <tuple>
 #include <set>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 
 #define BDD spotBDD
@@ -18,98 +23,169 @@ using namespace std;
 using namespace sdf;
 
 
-vector<string> get_controllable_APs(const string& hoa_file_name);
-bool get_synt_moore_flag(const string& hoa_file_name);
+/**
+ * The input text, read once into memory (from a file, stdin, or a pipe):
+ * the header is scanned and the automaton is parsed from this buffer, so the input is read in a single pass.
+ */
+class InputText
+{
+public:
+    explicit InputText(const string& file_name)
+    {
+        int fd = (file_name == "-") ? STDIN_FILENO : open(file_name.c_str(), O_RDONLY);
+        MASSERT(fd >= 0, "cannot open the file: " << file_name);
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+            buffer.reserve(st.st_size);
+        char chunk[1 << 16];
+        for (ssize_t n; (n = read(fd, chunk, sizeof(chunk))) != 0; )
+        {
+            MASSERT(n > 0, "cannot read the file: " << file_name);
+            buffer.append(chunk, n);
+        }
 
+        if (fd != STDIN_FILENO)
+            close(fd);
+    }
 
-std::tuple<spot::twa_graph_ptr, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
-sdf::read_ehoa(const string& hoa_file_name)
-{
-    // the parser assumes that the hoa file contains the additional lines:
-    // "controllable-AP: 1 2 3"  <-- this lines describes the indices of controllable APs
-    // "synt-moore: true" [optional] <-- describes if we need to synthesise Moore machines (also: "true" can be "false")
+    string_view text() const { return buffer; }
 
-    spot::bdd_dict_ptr dict = spot::make_bdd_dict();
-    spot::parsed_aut_ptr pa = parse_aut(hoa_file_name, dict);
-    { MASSERT(!pa->aborted, ""); if (stringstream ss; pa->format_errors(ss)) MASSERT(0, ss.str()); }
-    auto aut = pa->aut;
+    const char* c_str() const { return buffer.c_str(); }
 
-    std::unordered_set<spot::formula> inputs, outputs;
-    vector<string> controllableAPs = get_controllable_APs(hoa_file_name);
-    for (auto& ap : aut->ap())
-        if (contains(controllableAPs, ap.ap_name()))
-            outputs.insert(ap);
-        else
-            inputs.insert(ap);
+private:
+    string buffer;
+};
 
-    auto synt_moore = get_synt_moore_flag(hoa_file_name);
 
-    return {aut, inputs, outputs, synt_moore};
-}
+struct EhoaHeader
+{
+    vector<string> AP_names;             // respects the original order
+    vector<uint> controllable_AP_indices;
+    bool is_moore = false;               // default is false
+};
+
 
-vector<string> get_APs(const string& hoa_file_name)
+/** Split the header line into tokens; a quoted string is one token (without the quotes) */
+vector<string> tokenize_header_line(string_view line)
 {
-    // find the line and turn it into vector:
-    // AP: 4 "g_0" "r_0" "g_1" "r_1"
-    // the result respects the original order
-    ifstream f(hoa_file_name);
-    vector<string> AP_names;
-    for (string l; getline(f, l);) {
-        l = trim_spaces(l);
-        if (l.find("AP") == 0)
+    vector<string> tokens;
+    for (size_t i = 0; i < line.size(); )
+    {
+        if (isspace((unsigned char) line[i]))
         {
-            auto tokens = split_by_space(l);
-            // the tokens are "AP:", "4", '"g_0"', etc.
-            MASSERT(tokens.size()>2, "names must be present");
-
-            auto remove_quotes = [](const string& e){return substituteAll(e, "\"", "");};
-            transform(tokens.begin()+2, tokens.end(),
-                      back_inserter(AP_names), remove_quotes);
-            return AP_names;
+            ++i;
+            continue;
+        }
+        if (line[i] == '"')
+        {
+            auto end = line.find('"', i+1);
+            MASSERT(end != string_view::npos, "unterminated string in the line: " << line);
+            tokens.emplace_back(line.substr(i+1, end-i-1));
+            i = end + 1;
+            continue;
         }
+        auto end = i;
+        while (end < line.size() && !isspace((unsigned char) line[end]))
+            ++end;
+        tokens.emplace_back(line.substr(i, end-i));
+        i = end;
     }
-    MASSERT(0, "unreachable");
+    return tokens;
 }
 
-vector<string> get_controllable_APs(const string& hoa_file_name)
-{
-    vector<string> APs = get_APs(hoa_file_name);
 
-    ifstream f(hoa_file_name);
-    for (string l; getline(f, l);)
+/** Read the header lines we need (the scan stops at "--BODY--", so the body is not touched) */
+EhoaHeader parse_header(string_view text)
+{
+    EhoaHeader header;
+    bool has_APs = false;
+    for (size_t pos = 0; pos < text.size(); )
     {
-        l = trim_spaces(l);
-        if (l.find(CONTROLLABLE_AP_TKN) == 0)
+        auto eol = text.find('\n', pos);
+        auto line = text.substr(pos, (eol == string_view::npos ? text.size() : eol) - pos);
+        pos = (eol == string_view::npos) ? text.size() : eol + 1;
+
+        auto tokens = tokenize_header_line(line);
+        if (tokens.empty())
+            continue;
+        if (tokens[0] == "--BODY--")
+            break;
+
+        if (tokens[0] == "AP:")
+        {
+            // AP: 4 "g_0" "r_0" "g_1" "r_1"
+            MASSERT(tokens.size()>2, "names must be present");
+            header.AP_names.assign(tokens.begin()+2, tokens.end());
+            has_APs = true;
+        }
+        else if (tokens[0] == CONTROLLABLE_AP_TKN + ":")
         {
-            vector<string> controllableAPs;
-            auto tokens = split_by_space(l);  // tokens are: "controllable-AP:", "0", "2", etc.
+            // controllable-AP: 0 2
             for (auto it = tokens.begin() + 1; it != tokens.end(); ++it)
-                controllableAPs.push_back(APs[stoi(*it)]);
-            return controllableAPs;
+                header.controllable_AP_indices.push_back(stoi(*it));
+        }
+        else if (tokens[0] == SYNT_MOORE_TKN + ":")
+        {
+            MASSERT(tokens.size() == 2, "expected the line 'synt-moore: value'");
+            MASSERT(tokens[1] == "true" || tokens[1] == "false", "");
+            header.is_moore = tokens[1] == "true";
         }
     }
-    // reaching here means CONTROLLABLE_AP_TKN is missing alltogether (allowed).
-    return {};
+    MASSERT(has_APs, "the AP line is missing");
+    // (missing CONTROLLABLE_AP_TKN means no controllable APs (allowed))
+    return header;
 }
 
-bool get_synt_moore_flag(const string& hoa_file_name)
+
+static std::tuple<spot::twa_graph_ptr, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
+split_signals(const spot::twa_graph_ptr& aut, const EhoaHeader& header)
 {
-    ifstream f(hoa_file_name);
-    for (string l; getline(f, l);)
-    {
-        l = trim_spaces(l);
-        if (l.find(SYNT_MOORE_TKN) == 0)
-        {
-            auto tokens = split_by_space(l);
-            MASSERT(tokens.size() == 2, "expected the line 'synt-moore: value'");
+    vector<string> controllableAPs;
+    for (auto idx: header.controllable_AP_indices)
+        controllableAPs.push_back(header.AP_names.at(idx));
 
-            if (tokens[1] == "false")
-                return false;
-            else if (tokens[1] == "true")
-                return true;
-            else
-                MASSERT(0, "");
-        }
-    }
-    return false;  // default is false
+    std::unordered_set<spot::formula> inputs, outputs;
+    for (auto& ap : aut->ap())
+        if (contains(controllableAPs, ap.ap_name()))
+            outputs.insert(ap);
+        else
+            inputs.insert(ap);
+
+    return {aut, inputs, outputs, header.is_moore};
+}
+
+
+static spot::twa_graph_ptr check_parsed(const spot::parsed_aut_ptr& pa)
+{
+    MASSERT(!pa->aborted, "");
+    if (stringstream ss; pa->format_errors(ss))
+        MASSERT(0, ss.str());
+    return pa->aut;
+}
+
+
+std::tuple<spot::twa_graph_ptr, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
+sdf::read_ehoa(const string& hoa_file_name)
+{
+    // the parser assumes that the hoa file contains the additional lines:
+    // "controllable-AP: 1 2 3"  <-- this lines describes the indices of controllable APs
+    // "synt-moore: true" [optional] <-- describes if we need to synthesise Moore machines (also: "true" can be "false")
+
+    InputText input(hoa_file_name);
+    auto header = parse_header(input.text());
+
+    // (from the same buffer: the input is not read again)
+    auto aut = check_parsed(spot::automaton_stream_parser(input.c_str(), hoa_file_name).parse(spot::make_bdd_dict()));
+
+    return split_signals(aut, header);
+}
+
+
+std::tuple<spot::twa_graph_ptr, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
+sdf::read_ehoa_text(const string& hoa_text, const string& name)
+{
+    auto header = parse_header(hoa_text);
+    auto aut = check_parsed(spot::automaton_stream_parser(hoa_text.c_str(), name).parse(spot::make_bdd_dict()));
+    return split_signals(aut, header);
 }
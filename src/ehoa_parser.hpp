@@ -22,9 +22,16 @@ const std::string SYNT_MOORE_TKN = "synt-moore";            // NOLINT(cert-err58
  * controllable-AP: n1 n2 ...
  * where n1, n2 ... are the indices of the controllable APs.
  * Note: controllable-AP can also be missing alltogether.
+ * The input is read once, into memory: "-" means stdin (pipes are also fine).
  * @return: aut, inputs, outputs, is_moore
  */
 std::tuple<spot::twa_graph_ptr, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
 read_ehoa(const std::string& hoa_file_name);
 
+/**
+ * As read_ehoa, but the extended HOA is given as text (`name` is used in the error messages).
+ */
+std::tuple<spot::twa_graph_ptr, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
+read_ehoa_text(const std::string& hoa_text, const std::string& name = "ehoa");
+
 } //namespace sdf
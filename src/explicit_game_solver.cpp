@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+
+#define BDD spotBDD
+    #include <spot/twa/twagraph.hh>
+#undef BDD
+
+
+#include "explicit_game_solver.hpp"
+#include "utils.hpp"
+
+
+#define log_time(message) spdlog::info("{} took (sec): {}", message, timer.sec_restart());
+
+
+using namespace std;
+
+
+#define hmap unordered_map
+
+
+void sdf::ExplicitGameSolver::build_out_by_state()
+{
+    // the same label often appears on several edges of a state,
+    // so we group the edges by the label and translate every label only once
+    out_by_state.assign(aut->num_states(), {});
+    for (uint s = 0; s < aut->num_states(); ++s)
+    {
+        hmap<int, size_t> group_by_label_id;  // spot bdd id -> index in out_by_state[s]
+        for (const auto& t: aut->out(s))
+        {
+            auto [it, is_new] = group_by_label_id.emplace(t.cond.id(), out_by_state[s].size());
+            if (is_new)
+                out_by_state[s].emplace_back(translate_label(t.cond), vector<uint>());
+            out_by_state[s][it->second].second.push_back(t.dst);
+        }
+        for (auto& [label, dsts]: out_by_state[s])
+        {
+            sort(dsts.begin(), dsts.end());
+            dsts.erase(unique(dsts.begin(), dsts.end()), dsts.end());
+        }
+    }
+}
+
+
+uint sdf::ExplicitGameSolver::get_or_add_node(const vector<uint>& states)
+{
+    auto it = node_by_states.find(states);
+    if (it != node_by_states.end())
+        return it->second;
+
+    uint idx = nodes.size();
+    Node node;
+    node.states = states;
+    node.safe = cudd.bddZero();
+    node.is_losing = is_known_losing(states);
+    nodes.push_back(node);
+    node_by_states.emplace(states, idx);
+    return idx;
+}
+
+
+vector<uint> sdf::ExplicitGameSolver::get_initial_node_states()
+{
+    return {aut->get_init_state_number()};
+}
+
+
+const vector<pair<BDD, vector<uint>>>& sdf::ExplicitGameSolver::get_out_groups(uint s)
+{
+    return out_by_state[s];
+}
+
+
+vector<pair<BDD, vector<uint>>> sdf::ExplicitGameSolver::compute_successors(const vector<uint>& states)
+{
+    // We refine the partition {true -> {}} of the signal space by every outgoing label of every state.
+    // The blocks with the same successor are merged after each refinement, to keep the partition small.
+    // (The empty successor means that all the runs died, which is good for Eve.)
+
+    vector<pair<BDD, vector<uint>>> partition = {{cudd.bddOne(), {}}};
+    for (auto s: states)
+        for (const auto& [label, dsts]: get_out_groups(s))
+        {
+            vector<pair<BDD, vector<uint>>> refined;
+            hmap<vector<uint>, size_t, StatesHash> block_by_succ;
+            auto add_block = [&](const BDD& block, vector<uint>&& succ)
+            {
+                auto [it, is_new] = block_by_succ.emplace(succ, refined.size());
+                if (is_new)
+                    refined.emplace_back(block, move(succ));
+                else
+                    refined[it->second].first |= block;
+            };
+
+            for (const auto& [block, block_succ]: partition)
+            {
+                BDD block_in = block & label;
+                BDD block_out = block & ~label;
+                if (!block_in.IsZero())
+                {
+                    vector<uint> succ;
+                    set_union(block_succ.begin(), block_succ.end(), dsts.begin(), dsts.end(), back_inserter(succ));
+                    add_block(block_in, move(succ));
+                }
+                if (!block_out.IsZero())
+                    add_block(block_out, vector<uint>(block_succ));
+            }
+            partition = move(refined);
+        }
+
+    return partition;
+}
+
+
+bool sdf::ExplicitGameSolver::is_error(const vector<uint>& states)
+{
+    // (same as in GameSolver::build_error_bdd: reaching any of the accepting states is an error)
+    return any_of(states.begin(), states.end(),
+                  [&](uint s) { return aut->state_is_accepting(s); });
+}
+
+
+bool sdf::ExplicitGameSolver::can_stay_in(const BDD& safe)
+{
+    if (is_moore)  // ∃o ∀i
+        return safe.UnivAbstract(inputs_cube).ExistAbstract(outputs_cube).IsOne();
+    // ∀i ∃o
+    return safe.ExistAbstract(outputs_cube).UnivAbstract(inputs_cube).IsOne();
+}
+
+
+void sdf::ExplicitGameSolver::expand(uint n)
+{
+    throw_if_cancelled();  // (every engine on macro-states expands them here)
+    auto successors = compute_successors(nodes[n].states);
+    BDD safe = cudd.bddZero();
+    for (auto& [label, succ]: successors)
+    {
+        if (is_error(succ))
+            continue;
+        uint dst = get_or_add_node(succ);
+        if (nodes[dst].is_losing)
+            continue;
+        nodes[dst].preds.emplace_back(n, nodes[n].moves.size());
+        nodes[n].moves.push_back({label, dst});
+        safe |= label;
+    }
+    nodes[n].safe = safe;
+    nodes[n].is_expanded = true;
+}
+
+
+void sdf::ExplicitGameSolver::explore()
+{
+    spdlog::info("explore..");
+
+    for (uint n = 0; n < nodes.size(); ++n)  // (`nodes` grows during the loop)
+        expand(n);
+
+    spdlog::info("explore: {} macro-states ({} automaton states), BDD node count {}",
+                 nodes.size(), aut->num_states(), cudd.ReadNodeCount());
+}
+
+
+bool sdf::ExplicitGameSolver::propagate(vector<uint> worklist)
+{
+    /** Backward attractor for Adam:
+     *  a node is losing iff Eve cannot ensure that the move is among the moves leading to non-losing nodes.
+     *  When a node becomes losing, we remove the corresponding moves from its predecessors and re-check them.
+     */
+
+    while (!worklist.empty())
+    {
+        throw_if_cancelled();
+        uint n = worklist.back();
+        worklist.pop_back();
+
+        if (nodes[n].is_losing || !nodes[n].is_expanded || can_stay_in(nodes[n].safe))
+            continue;
+
+        nodes[n].is_losing = true;
+        if (n == 0)
+            return false;  // the initial node is losing
+        on_losing(n);
+
+        for (auto [p, move_idx]: nodes[n].preds)
+            if (!nodes[p].is_losing)
+            {
+                nodes[p].safe &= ~nodes[p].moves[move_idx].label;
+                worklist.push_back(p);
+            }
+    }
+    return true;
+}
+
+
+bool sdf::ExplicitGameSolver::solve_game()
+{
+    explore();
+    log_time("explore");
+
+    if (!propagate(range<uint>(0, nodes.size())))
+        return false;
+
+    spdlog::info("solve: {} of {} macro-states are winning",
+                 count_if(nodes.begin(), nodes.end(), [](const Node& node) { return !node.is_losing; }),
+                 nodes.size());
+    return true;
+}
+
+
+bool sdf::ExplicitGameSolver::check_realizability()
+{
+    init_cudd();
+
+    declare_signal_vars();  // the state variables are declared only when we synthesize a model
+
+    auto uncontrollable = get_uncontrollable_vars_bdds();
+    auto controllable = get_controllable_vars_bdds();
+    inputs_cube = cudd.bddComputeCube(uncontrollable.data(), nullptr, (int)uncontrollable.size());
+    outputs_cube = cudd.bddComputeCube(controllable.data(), nullptr, (int)controllable.size());
+
+    timer.sec_restart();
+    build_out_by_state();
+    log_time("translating the labels");
+
+    auto init_states = get_initial_node_states();
+    if (is_error(init_states))
+        return false;
+
+    nodes.clear();
+    node_by_states.clear();
+    uint init_node = get_or_add_node(init_states);  // (index 0)
+    if (nodes[init_node].is_losing)
+        return false;
+
+    bool is_init_winning = solve_game();
+    log_time("solve_game");
+
+    return is_init_winning;
+}
+
+
+BDD sdf::ExplicitGameSolver::state_cube(const vector<uint>& states)
+{
+    vector<int> phases;
+    for (const auto& v: state_vars)
+        phases.push_back(binary_search(states.begin(), states.end(), v.NodeReadIndex() - NOF_SIGNALS) ? 1 : 0);
+    return cudd.bddComputeCube(state_vars.data(), phases.data(), (int)state_vars.size());
+}
+
+
+BDD sdf::ExplicitGameSolver::get_nondet_strategy()
+{
+    spdlog::info("get_nondet_strategy (explicit)..");
+
+    // now we need the symbolic encoding of the automaton: it defines the latches of the model
+    declare_state_vars();
+    build_init_state_bdd();
+    build_pre_trans_func();
+    build_error_bdd();
+
+    state_vars.clear();
+    for (uint s = 0; s < aut->num_states(); ++s)
+        if (pre_trans_func.count(s + NOF_SIGNALS))  // (the accepting sinks have no latches)
+            state_vars.push_back(cudd.ReadVars((int)(s + NOF_SIGNALS)));
+
+    // The strategy is defined on the explored macro-states only:
+    // other latch valuations are unreachable when Eve follows the strategy.
+    BDD strategy = cudd.bddZero();
+    for (const auto& node: nodes)
+        if (!node.is_losing)
+            strategy |= state_cube(node.states) & node.safe;
+    return strategy;
+}
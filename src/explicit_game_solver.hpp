@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "game_solver.hpp"
+#include "utils.hpp"
+
+
+namespace sdf
+{
+
+/**
+ * Game solver that keeps the automaton states explicit and
+ * uses BDDs only to describe the moves (over inputs and outputs).
+ *
+ * The automaton is universal, hence a game position is a set of automaton states (a macro-state);
+ * the solver explores the macro-states reachable from the initial one,
+ * then computes the losing positions via the worklist-based backward attractor.
+ * No state variables and no VectorCompose are used for solving the game:
+ * the state variables are introduced only if we need to synthesize a model,
+ * so the produced AIGER circuit is the same as the one produced by GameSolver.
+ *
+ * Good for automata with up to a few thousands states (after k-reduction).
+ */
+class ExplicitGameSolver : public GameSolver
+{
+
+public:
+    ExplicitGameSolver(bool is_moore_,
+                       const std::unordered_set<spot::formula>& inputs_,
+                       const std::unordered_set<spot::formula>& outputs_,
+                       const spot::twa_graph_ptr& aut_,  // NOLINT(*-pass-by-value)
+                       const bool do_reach_optim,
+                       uint time_limit_sec_ = 3600) :
+        GameSolver(is_moore_, inputs_, outputs_, aut_, do_reach_optim, time_limit_sec_)
+    { }
+
+    bool check_realizability() override;
+
+protected:
+    struct Move
+    {
+        BDD label;  // over inputs and outputs; the labels of the moves of the same node do not intersect
+        uint dst;   // node index
+    };
+
+    struct Node
+    {
+        std::vector<uint> states;                      // sorted automaton states
+        std::vector<Move> moves;                       // moves to non-error nodes
+        BDD safe;                                      // the labels of moves that lead to not-yet-losing nodes
+        bool is_expanded = false;                      // are the moves computed?
+        bool is_losing = false;
+        std::vector<std::pair<uint, uint>> preds;      // (node, index of its move leading to this node)
+    };
+
+    struct StatesHash
+    {
+        size_t operator()(const std::vector<uint>& states) const
+        {
+            return hash_ordered(states, std::hash<uint>());
+        }
+    };
+
+    std::vector<Node> nodes;                                                  // nodes[0] is the initial node
+    std::unordered_map<std::vector<uint>, uint, StatesHash> node_by_states;
+
+    // for each automaton state: its outgoing edges grouped by label: (label, destination states)
+    std::vector<std::vector<std::pair<BDD, std::vector<uint>>>> out_by_state;
+
+    BDD inputs_cube;
+    BDD outputs_cube;
+
+    std::vector<BDD> state_vars;  // (declared only when synthesizing)
+
+protected:
+    void build_out_by_state();
+
+    /** @return the node index (creates the node if it is new) */
+    uint get_or_add_node(const std::vector<uint>& states);
+
+    // The hooks below allow the subclasses to use other kinds of "states" in the nodes.
+
+    virtual std::vector<uint> get_initial_node_states();
+
+    /** @return the outgoing edges of the state grouped by label: (label, destination states) */
+    virtual const std::vector<std::pair<BDD, std::vector<uint>>>& get_out_groups(uint s);
+
+    /** @return the partition of the signal space into (label, successor macro-state) */
+    virtual std::vector<std::pair<BDD, std::vector<uint>>> compute_successors(const std::vector<uint>& states);
+
+    virtual bool is_error(const std::vector<uint>& states);
+
+    /** is called on the creation of the node: true means the node is losing without exploration */
+    virtual bool is_known_losing(const std::vector<uint>& states) { return false; }
+
+    /** is called when the node becomes losing */
+    virtual void on_losing(uint n) { }
+
+    /** @return true iff Eve can ensure that the move is among `safe` (wrt. is_moore) */
+    bool can_stay_in(const BDD& safe);
+
+    /** compute the moves of the node (adds the successor nodes if they are new) */
+    void expand(uint n);
+
+    /**
+     * Backward attractor for Adam starting from the given nodes (non-expanded nodes are assumed to be winning).
+     * @return false iff the initial node became losing
+     */
+    bool propagate(std::vector<uint> worklist);
+
+    void explore();
+
+    /** @return true iff the initial node is winning */
+    virtual bool solve_game();
+
+    BDD state_cube(const std::vector<uint>& states);
+
+    BDD get_nondet_strategy() override;
+};
+
+
+} // namespace sdf
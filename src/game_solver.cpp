@@ -1,5 +1,8 @@
 #include <iostream>
 #include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <unistd.h>
 #include <spdlog/spdlog.h>
 
 
@@ -11,6 +14,9 @@
 
 
 #include "game_solver.hpp"
+#include "atm_helper.hpp"
+#include "bdd_io.hpp"
+#include "reachability.hpp"
 #include "utils.hpp"
 
 #include <cuddInt.h>  // useful for debugging to access the reference count
@@ -82,15 +88,27 @@ void sdf::GameSolver::build_error_bdd()
     // Assumptions:
     // - acceptance is state-based,
     // - state is accepting => state has a self-loop with true.
+    // An accepting sink (after k_reduce, all the accepting states are) has no latch (see build_pre_trans_func):
+    // instead, the transitions into it are the error, error(t,u,c) = ∨ s & label(s -> sink).
     spdlog::info("build_error_bdd..");
 
     MASSERT(aut->is_sba() == spot::trival::yes_value, "is the automaton with Buchi-state acceptance?");
     MASSERT(aut->prop_terminal() == spot::trival::yes_value, "is the automaton terminal?");
 
+    if (is_acc_sink(aut, aut->get_init_state_number()))
+    {
+        error = cudd.bddOne();
+        return;
+    }
+
     error = cudd.bddZero();
     for (auto s = 0u; s < aut->num_states(); ++s)
-        if (aut->state_is_accepting(s))
+        if (aut->state_is_accepting(s) && !is_acc_sink(aut, s))
             error |= cudd.bddVar(s + NOF_SIGNALS);  // NOLINT(cppcoreguidelines-narrowing-conversions)
+    for (auto& t: aut->edges())
+        if (is_acc_sink(aut, t.dst) && !is_acc_sink(aut, t.src))
+            error |= cudd.ReadVars(t.src + NOF_SIGNALS)  // NOLINT(cppcoreguidelines-narrowing-conversions)
+                     & translate_label(t.cond);
 
 //    dumpBddAsDot(cudd, error, "error");
 }
@@ -101,66 +119,67 @@ void sdf::GameSolver::build_init_state_bdd()
     spdlog::info("build_init_state_bdd..");
 
     // Initial state is 'the latch of the initial state is 1, others are 0'
-    // (there is only one initial state)
+    // (there is only one initial state; the accepting sinks have no latches)
+    init_latches = {aut->get_init_state_number() + NOF_SIGNALS};
+    if (is_acc_sink(aut, aut->get_init_state_number()))
+        init_latches.clear();  // (then every move is an error)
     init = cudd.bddOne();
     for (auto s = 0u; s < aut->num_states(); s++)
-        if (s != aut->get_init_state_number())
+        if (is_acc_sink(aut, s))
+            continue;
+        else if (s != aut->get_init_state_number())
             init &= ~cudd.bddVar(s + NOF_SIGNALS); // NOLINT(cppcoreguidelines-narrowing-conversions)
         else
             init &= cudd.bddVar(s + NOF_SIGNALS);  // NOLINT(cppcoreguidelines-narrowing-conversions)
 }
 
 
-BDD bdd_from_ap(const spot::formula& ap,
-                const vector<spot::formula>& inputs_outputs,
-                Cudd& cudd)
+BDD sdf::GameSolver::translate_label(const bdd& label)
 {
-    long idx = distance(inputs_outputs.begin(),
-                        find(inputs_outputs.begin(), inputs_outputs.end(), ap));
-    MASSERT(idx < (long) inputs_outputs.size(), "idx is out of range for proposition: " << ap);
-    return cudd.bddVar((int) idx);
-}
-
-
-BDD translate_formula_into_cuddBDD(const spot::formula& formula,
-                                   vector<spot::formula>& inputs_outputs,
-                                   Cudd& cudd)
-{
-    // formula is the sum of products (i.e., in DNF)
-    if (formula.is(spot::op::Or))
-    {
-        BDD cudd_bdd = cudd.bddZero();
-        for (auto l: formula)
-            cudd_bdd |= translate_formula_into_cuddBDD(l, inputs_outputs, cudd);
-        return cudd_bdd;
-    }
+    /**
+     * Transfer the spot (BuDDy) BDD into CUDD node by node:
+     * every BuDDy node `ite(v, high, low)` becomes `ite(cudd var of v, high', low')`.
+     * The nodes are memoized by their BuDDy ids: the labels of `aut` are alive during the solving,
+     * so their ids (and the ids of their sub-nodes) are not reused,
+     * and the same label (which typically repeats on many edges) is translated once.
+     */
 
-    if (formula.is(spot::op::And))
+    if (cuddIdx_by_spot_var.empty())
     {
-        BDD cudd_bdd = cudd.bddOne();
-        for (auto l: formula)
-            cudd_bdd &= translate_formula_into_cuddBDD(l, inputs_outputs, cudd);
-        return cudd_bdd;
+        const spot::bdd_dict_ptr& spot_bdd_dict = aut->get_dict();
+        for (uint i = 0; i < inputs_outputs.size(); ++i)
+        {
+            int spot_var = spot_bdd_dict->varnum(inputs_outputs[i]);
+            if (spot_var >= 0)  // (the automaton may not mention some signals)
+                cuddIdx_by_spot_var[spot_var] = i;
+        }
     }
 
-    if (formula.is(spot::op::ap))
-        return bdd_from_ap(formula, inputs_outputs, cudd);
+    if (label == bdd_true())
+        return cudd.bddOne();
+    if (label == bdd_false())
+        return cudd.bddZero();
 
-    if (formula.is(spot::op::Not))
-    {
-        MASSERT(formula[0].is(spot::op::ap), formula);
-        return ~bdd_from_ap(formula[0], inputs_outputs, cudd);
-    }
+    auto it = cudd_by_spot_id.find(label.id());
+    if (it != cudd_by_spot_id.end())
+        return it->second;
 
-    if (formula.is(spot::op::tt))
-        return cudd.bddOne();  // no restriction
+    auto var_it = cuddIdx_by_spot_var.find(bdd_var(label));
+    MASSERT(var_it != cuddIdx_by_spot_var.end(),
+            "the proposition is neither input nor output: " << aut->get_dict()->bdd_map[bdd_var(label)].f);
 
-    MASSERT(0, "unexpected type of f: " << formula);
+    BDD result = cudd.ReadVars((int)var_it->second).Ite(translate_label(bdd_high(label)),
+                                                        translate_label(bdd_low(label)));
+    cudd_by_spot_id.emplace(label.id(), result);
+    return result;
 }
 
+
 void sdf::GameSolver::build_pre_trans_func()
 {
     // This function ensures: for each state, cuddIdx = state+NOF_SIGNALS
+    // The accepting sinks get no latch: entering one is the error (see build_error_bdd), so the latch would never be read.
+    // (Their variables are still declared, to keep cuddIdx = state+NOF_SIGNALS, but they occur in no BDD.)
     spdlog::info("build_pre_trans_func..");
 
     const spot::bdd_dict_ptr& spot_bdd_dict = aut->get_dict();
@@ -179,27 +198,23 @@ void sdf::GameSolver::build_pre_trans_func()
 
     // assumption: in the automaton, states are numbered from 0 to n-1
 
-    hmap<uint, vector<spot::twa_graph::edge_storage_t>> in_edges_by_state;
-    for (uint s = 0; s < aut->num_states(); ++s)
-        for (auto &t: aut->edges())
-            if (t.dst == s)
-                in_edges_by_state[s].push_back(t);
-
+    vector<bool> is_sink(aut->num_states());
     for (uint s = 0; s < aut->num_states(); ++s)
     {
-        BDD s_transitions = cudd.bddZero();
-        for (auto &t: in_edges_by_state[s])
-        {   // t has src, dst, cond, acc
-            //INF("  edge: " << t.src << " -> " << t.dst << ": " << spot::bdd_to_formula(t.cond, spot_bdd_dict) << ": " << t.acc);
-
-            BDD s_t = cudd.ReadVars(t.src + NOF_SIGNALS)  // NOLINT(cppcoreguidelines-narrowing-conversions)
-                      & translate_formula_into_cuddBDD(spot::bdd_to_formula(t.cond, spot_bdd_dict), inputs_outputs, cudd);
-            s_transitions |= s_t;
-        }
-        pre_trans_func[s + NOF_SIGNALS] = s_transitions;
+        is_sink[s] = is_acc_sink(aut, s);
+        if (!is_sink[s])
+            pre_trans_func[s + NOF_SIGNALS] = cudd.bddZero();
+    }
 
-//        dumpBddAsDot(cudd, s_transitions, "s" + to_string(s));
+    for (auto &t: aut->edges())  // (a single pass over the edges)
+    {   // t has src, dst, cond, acc
+        if (is_sink[t.src] || is_sink[t.dst])
+            continue;
+        //INF("  edge: " << t.src << " -> " << t.dst << ": " << spot::bdd_to_formula(t.cond, spot_bdd_dict) << ": " << t.acc);
 
+        BDD s_t = cudd.ReadVars(t.src + NOF_SIGNALS)  // NOLINT(cppcoreguidelines-narrowing-conversions)
+                  & translate_label(t.cond);
+        pre_trans_func[t.dst + NOF_SIGNALS] |= s_t;
     }
 }
 
@@ -208,10 +223,11 @@ vector<BDD> sdf::GameSolver::get_substitution()
 {
     vector<BDD> substitution;
 
+    // (VectorCompose takes all variables: the primed ones of Reachability, if any, have no latch)
     for (uint i = 0; i < (uint)cudd.ReadSize(); ++i)
-        if (i >= inputs_outputs.size())  // is a state variable
+        if (i >= inputs_outputs.size() && pre_trans_func.count(i))  // is a latch
             substitution.push_back(pre_trans_func.at(i));
-        else
+        else  // (a signal, or a variable without latch (occurs in no BDD))
             substitution.push_back(cudd.ReadVars(i));
 
     return substitution;
@@ -336,154 +352,399 @@ BDD sdf::GameSolver::get_nondet_strategy()
 }
 
 
-BDD extract_one_func_via_squeeze(const Cudd& cudd, BDD& can_be_true, BDD& can_be_false)
+/**
+ * @return the result of `compute`, or nullopt if it did not finish within the time limit (then CUDD aborted it).
+ * Within an outer time limit (see GameSolver::synthesize_anytime), the limit is cut to what is left of the outer one,
+ * and the outer one is restored afterwards.
+ */
+static optional<BDD> with_time_limit(const Cudd& cudd, unsigned long limit_ms, const function<BDD()>& compute)
 {
-    BDD c_must_be_true = ~can_be_false & can_be_true;
-//    BDD c_must_be_false = ~can_be_true & can_be_false;
-
-//    auto support_indicesF = cudd.SupportIndices(vector<BDD>{c_must_be_false});
-//    auto support_indicesT = cudd.SupportIndices(vector<BDD>{c_must_be_true});
-
-//    auto siF = set<uint>(support_indicesF.begin(), support_indicesF.end());
-//    auto siT = set<uint>(support_indicesT.begin(), support_indicesT.end());
-
-//    vector<uint> diff;
-//    set_symmetric_difference(siF.begin(), siF.end(), siT.begin(), siT.end(), std::back_inserter(diff));
-//    spdlog::info("number of variables present in one but not in the other: {}", diff.size());
-//    copy(diff.begin(), diff.end(), std::ostream_iterator<uint>(std::cout, " "));
-//    cout << endl;
-
-    // Hm, I don't think it is worth? On two examples, it showed no benefit.
-//    for (auto new_var_cudd_idx : diff)
-//    {
-//        auto new_v = cudd.ReadVars((int)new_var_cudd_idx);
-//        c_must_be_false = c_must_be_false.ExistAbstract(new_v);
-//        c_must_be_true = c_must_be_true.ExistAbstract(new_v);
-//        can_be_true = can_be_true.ExistAbstract(new_v);
-//    }
-
-    // Note that we cannot use `c_must_be_true = ~c_can_be_false`,
-    // since the negation can cause including tuples (t,i,o) that violate non_det_strategy.
-
-    can_be_false = cudd.bddZero();
-//    c_must_be_false = cudd.bddZero();
+    optional<pair<unsigned long, unsigned long>> outer;  // (start time, limit)
+    if (cudd.TimeLimited())
+    {
+        outer = {cudd.ReadStartTime(), cudd.ReadTimeLimit()};
+        auto elapsed_ms = cudd.ReadElapsedTime();
+        limit_ms = min(limit_ms, outer->second > elapsed_ms ? outer->second - elapsed_ms : 0ul);
+    }
+    auto restore = [&]()
+    {
+        cudd.UnsetTimeLimit();
+        if (outer)
+        {
+            cudd.SetStartTime(outer->first);
+            cudd.SetTimeLimit(outer->second);
+        }
+    };
 
-    return c_must_be_true.Squeeze(can_be_true);
+    optional<BDD> result;
+    try
+    {
+        cudd.ResetStartTime();
+        cudd.SetTimeLimit(limit_ms);
+        result = compute();
+    }
+    catch (const logic_error&)
+    {
+        restore();
+        if (cudd.ReadErrorCode() != CUDD_TIMEOUT_EXPIRED)
+            throw;  // (e.g., cancelled)
+        cudd.ClearErrorCode();
+        return result;
+    }
+    restore();
+    return result;
 }
 
 
-BDD extract_one_func_via_abstraction(const Cudd& cudd, BDD& can_be_true, BDD& can_be_false, const BDD& reachable)
-{
-    BDD c_must_be_true = ~can_be_false & can_be_true;
-    BDD c_must_be_false = can_be_false & ~can_be_true;
-    // Note that we cannot use `c_must_be_true = ~c_can_be_false`,
-    // since the negation can cause including tuples (t,i,o) that violate non_det_strategy.
-
-    // Note: having reachable=bddOne is equivalent to having no reachability optimization
+/* The output function must be 1 where `must_be_true`, 0 where `must_be_false`, and is free elsewhere
+ * (where both values are allowed, outside the winning region, and in the unreachable states).
+ * Note: having reachable=bddOne is equivalent to having no reachability optimization. */
 
-    can_be_false = can_be_true = cudd.bddZero();  // killing node refs
+/** ExtractMethod::abstraction: the number of outputs for which the variable was quantified away (shared by the outputs) */
+using AbstractionHints = hmap<uint, uint>;
 
-    // we now optimize c_must_be_true
+static BDD extract_one_func_via_abstraction(const Cudd& cudd,
+                                            const BDD& c_must_be_true, const BDD& c_must_be_false, const BDD& reachable,
+                                            AbstractionHints& hints)
+{
+    // we optimize c_must_be_true
 
-    // NOTE: The following optimization takes a lot of time.
-    //       It does reduce circuit size, but does it worth the increased time?
-    auto support_indices = cudd.SupportIndices({c_must_be_false, c_must_be_true});
+    // Only the reachable states matter, so the reachability is conjoined once, and then
+    // a variable v can be quantified away iff ∃v:T & ∃v:F = 0.
+    // As T and F are disjoint, this is T|v & F|~v = 0 and T|~v & F|v = 0, i.e., two Leq tests on the cofactors,
+    // which build no conjunction, and the abstractions are computed only for the variables that pass.
+    BDD T = c_must_be_true & reachable;
+    BDD F = c_must_be_false & reachable;
 
-    auto vars_abstracted_away = vector<uint>();
+    auto support_indices = cudd.SupportIndices({T, F});
 
     // Are some orders of variable abstraction better than others?
-    // The following order is based on hypothesis that larger-index variables play less important role:
+    // The variables quantified away for the previous outputs go first: the outputs often share them.
+    // Then the hypothesis that larger-index variables play less important role:
     // usually, the larger the automaton state the closer it is to the rejecting state,
-    // whereas the inputs have the smallest BDD indices.
+    // whereas the inputs have the smallest BDD indices (on abcg_arbiter, this shows substantial reduction (without -a)).
     // This is an heuristics. There are better ways for finding automata states that likely do not affect the output.
-    std::sort(support_indices.begin(), support_indices.end(), std::greater<>());  // on abcg_arbiter, this shows substantial reduction (without -a)
+    std::sort(support_indices.begin(), support_indices.end(),
+              [&](uint i1, uint i2)
+              {
+                  auto h1 = hints.count(i1) ? hints.at(i1) : 0, h2 = hints.count(i2) ? hints.at(i2) : 0;
+                  return h1 != h2 ? h1 > h2 : i1 > i2;
+              });
 
-    for (auto var_cudd_idx : support_indices)
+    auto vars_abstracted_away = vector<uint>();
+    sdf::WallTimer timer;
+    for (size_t i = 0; i < support_indices.size(); ++i)
     {
-        auto v = cudd.ReadVars((int)var_cudd_idx);
-
-        auto new_c_must_be_false = c_must_be_false.ExistAbstract(v);
-        auto new_c_must_be_true = c_must_be_true.ExistAbstract(v);
+        if (timer.sec_from_origin() >= sdf::EXTRACT_ABSTRACTION_SEC)
+        {
+            spdlog::info("extract model: the abstraction exceeded {} sec, the remaining {} variables are kept",
+                         sdf::EXTRACT_ABSTRACTION_SEC, support_indices.size() - i);
+            break;
+        }
 
-        if (((new_c_must_be_false & new_c_must_be_true) & reachable) == cudd.bddZero())
+        auto var_cudd_idx = support_indices[i];
+        auto v = cudd.ReadVars((int)var_cudd_idx);
+        auto T_pos = T.Cofactor(v), T_neg = T.Cofactor(~v);
+        auto F_pos = F.Cofactor(v), F_neg = F.Cofactor(~v);
+        if (T_pos.Leq(~F_neg) && T_neg.Leq(~F_pos))
         {
-            c_must_be_false = new_c_must_be_false;
-            c_must_be_true = new_c_must_be_true;
+            T = T_pos | T_neg;  // = ∃v:T
+            F = F_pos | F_neg;
             vars_abstracted_away.push_back(var_cudd_idx);
+            ++hints[var_cudd_idx];
         }
     }
 
     spdlog::info("extract model: the variables were quantified away: {}", sdf::join(", ", vars_abstracted_away));
 
-    return c_must_be_true.Restrict((c_must_be_true | c_must_be_false) & reachable);
+    return T.Restrict(T | F);
 }
 
-BDD sdf::GameSolver::compute_monolithic_T()
+
+static BDD extract_one_func(const Cudd& cudd, sdf::ExtractMethod method,
+                            const BDD& must_be_true, const BDD& must_be_false, const BDD& reachable,
+                            AbstractionHints& hints)
 {
-    spdlog::info("compute_monolithic_T: computing monolithic T(x,i,o,x')...");
-    auto start_time = timer.sec_from_origin();
+    auto care = (must_be_true | must_be_false) & reachable;
+    switch (method)
+    {
+        case sdf::ExtractMethod::abstraction:
+            return extract_one_func_via_abstraction(cudd, must_be_true, must_be_false, reachable, hints);
+        case sdf::ExtractMethod::squeeze:
+            return (must_be_true & reachable).Squeeze(~(must_be_false & reachable));
+        case sdf::ExtractMethod::li_compaction:
+            return must_be_true.LICompaction(care);
+        case sdf::ExtractMethod::isop:
+            return (must_be_true & reachable).Isop(~(must_be_false & reachable));
+        case sdf::ExtractMethod::restrict:
+            return must_be_true.Restrict(care);
+        case sdf::ExtractMethod::constrain:
+            return care.IsZero() ? cudd.bddZero() : must_be_true.Constrain(care);
+        case sdf::ExtractMethod::best:
+            break;
+    }
+    UNREACHABLE();
+}
 
-    auto getCuddIdxState       = [&](int s) { return (int)(NOF_SIGNALS + s); };
-    auto getCuddIdxPrimedState = [&](int s) { return (int)(NOF_SIGNALS + aut->num_states() + s); };
 
-    BDD T = cudd.bddOne();
-    for (auto s = 0; s < (int)aut->num_states(); ++s)
-    {
-        T &= ~(cudd.bddVar(getCuddIdxPrimedState(s)) ^ pre_trans_func.at(getCuddIdxState(s)));
+static const vector<pair<sdf::ExtractMethod, string>> METHODS_TO_TRY =  // (cheap ones first)
+    {{sdf::ExtractMethod::restrict, "restrict"}, {sdf::ExtractMethod::squeeze, "squeeze"}, {sdf::ExtractMethod::li_compaction, "li-compaction"},
+     {sdf::ExtractMethod::constrain, "constrain"}, {sdf::ExtractMethod::isop, "isop"}, {sdf::ExtractMethod::abstraction, "abstraction"}};
 
-        string name = string("s'") + to_string(s);  // we create a name for a newly created BDD variable for the primed state variable
-        cudd.pushVariableName(name);
+/** sdf::ExtractMethod::best: try every method within EXTRACT_TRY_SEC, keep the smallest result */
+static BDD extract_one_func_best(const Cudd& cudd, const BDD& must_be_true, const BDD& must_be_false, const BDD& reachable,
+                                 AbstractionHints& hints)
+{
+    optional<BDD> best;
+    string best_name;
+    for (const auto& [method, name]: METHODS_TO_TRY)
+    {
+        auto func = with_time_limit(cudd, sdf::EXTRACT_TRY_SEC * 1000,
+                                    [&, method = method]() { return extract_one_func(cudd, method, must_be_true, must_be_false, reachable, hints); });
+        if (!func)
+        {
+            spdlog::info("extract model: {}: exceeded {} sec", name, sdf::EXTRACT_TRY_SEC);
+            continue;
+        }
+        spdlog::info("extract model: {}: {} nodes", name, func->nodeCount());
+        if (!best || func->nodeCount() < best->nodeCount())
+        {
+            best = func;
+            best_name = name;
+        }
     }
+    if (!best)  // (unlikely: restrict is cheap)
+        return extract_one_func(cudd, sdf::ExtractMethod::restrict, must_be_true, must_be_false, reachable, hints);
+    spdlog::info("extract model: the best is {}", best_name);
+    return *best;
+}
 
-    spdlog::info("compute_monolithic_T took (sec.): {}", timer.sec_from_origin() - start_time);
+optional<BDD> sdf::GameSolver::compute_reachable_explicitly()
+{
+    auto constraint = non_det_strategy & ~error;
 
-    return T;
+    vector<BDD> state_vars;  // (of the states with latches)
+    for (uint s = 0; s < aut->num_states(); ++s)
+        if (pre_trans_func.count(s + NOF_SIGNALS))
+            state_vars.push_back(cudd.ReadVars((int)(s + NOF_SIGNALS)));
+    auto state_cube = [&](const vector<uint>& states)  // (states are sorted)
+    {
+        vector<int> phases;
+        for (const auto& v: state_vars)
+            phases.push_back(binary_search(states.begin(), states.end(), v.NodeReadIndex() - NOF_SIGNALS) ? 1 : 0);
+        return cudd.bddComputeCube(state_vars.data(), phases.data(), (int)state_vars.size());
+    };
+
+    vector<vector<pair<BDD, uint>>> edges_by_state(aut->num_states());  // (label, dst)
+    for (const auto& e: aut->edges())
+        edges_by_state[e.src].emplace_back(translate_label(e.cond), e.dst);
+
+    vector<uint> init_states;
+    for (auto cuddIdx: init_latches)
+        init_states.push_back(cuddIdx - NOF_SIGNALS);
+    sort(init_states.begin(), init_states.end());
+
+    set<vector<uint>> visited = {init_states};
+    vector<vector<uint>> worklist = {init_states};
+    BDD reachable = cudd.bddZero();
+    while (!worklist.empty())
+    {
+        auto states = worklist.back();
+        worklist.pop_back();
+        auto cube = state_cube(states);
+        reachable |= cube;
+
+        // split the letters allowed by the strategy by the edges they enable: successor macro-state -> letters
+        map<vector<uint>, BDD> letters_by_succ = {{{}, constraint.Cofactor(cube)}};
+        for (auto s: states)
+            for (const auto& [label, dst]: edges_by_state[s])
+            {
+                map<vector<uint>, BDD> refined;
+                for (const auto& [succ, letters]: letters_by_succ)
+                {
+                    auto enabled = letters & label;
+                    auto disabled = letters & ~label;
+                    if (!enabled.IsZero())
+                    {
+                        auto succ_with_dst = succ;
+                        if (!contains(succ_with_dst, dst))
+                            succ_with_dst.insert(lower_bound(succ_with_dst.begin(), succ_with_dst.end(), dst), dst);
+                        auto [it, is_new] = refined.emplace(succ_with_dst, enabled);
+                        if (!is_new)
+                            it->second |= enabled;
+                    }
+                    if (!disabled.IsZero())
+                    {
+                        auto [it, is_new] = refined.emplace(succ, disabled);
+                        if (!is_new)
+                            it->second |= disabled;
+                    }
+                }
+                letters_by_succ = move(refined);
+            }
+
+        for (const auto& [succ, letters]: letters_by_succ)
+            if (!letters.IsZero() && visited.insert(succ).second)
+            {
+                if (visited.size() > explicit_reach_bound)
+                {
+                    spdlog::info("compute_reachable_explicitly: more than {} macro-states, giving up", explicit_reach_bound);
+                    return nullopt;
+                }
+                worklist.push_back(succ);
+            }
+    }
+
+    spdlog::info("compute_reachable_explicitly: {} macro-states are reachable", visited.size());
+    return reachable;
 }
 
-BDD sdf::GameSolver::compute_reachable(const BDD& T)
-{
-    // 1. build the transition relation T(x,i,o,x'),
-    // 2. compute the set of reachable states.
-    // Unfortunately, T(x,i,o,x') is one large monolithic relation and uses the primed variables.
-    // (I don't know how to compute reachable states without using the primed variables and monolithic T.)
 
-    auto start_time_sec = timer.sec_from_origin();
+BDD sdf::GameSolver::compute_reachable()
+{
     spdlog::info("compute_reachable...");
+    auto start_time_sec = wall_timer.sec_from_origin();
+
+    Reachability reachability(cudd, pre_trans_func, a_union_b(get_uncontrollable_vars_bdds(), get_controllable_vars_bdds()));
+    auto constraint = non_det_strategy & ~error;
+
+    // The cost model: one image step costs about the product of the sizes of the constraint and of the next-state functions,
+    // while the model extraction abstracts every variable from every output function: about (outputs x variables x strategy size).
+    // The don't-cares pay off unless the reachability is much more expensive than the extraction they simplify.
+    // (The explicit exploration images the strategy once per macro-state, so the check applies to it as well.)
+    auto reach_cost = reachability.estimate_image_cost(constraint);
+    auto extraction_cost = (double) outputs.size() * nof_game_vars * non_det_strategy.nodeCount();
+    if (reach_cost > R_OPTIM_COST_RATIO * extraction_cost)
+    {
+        spdlog::info("compute_reachable: skipped: the predicted cost of an image {:.3g} exceeds {} x the extraction cost {:.3g}",
+                     reach_cost, R_OPTIM_COST_RATIO, extraction_cost);
+        return cudd.bddOne();
+    }
+
+    if (auto reachable = compute_reachable_explicitly())
+    {
+        spdlog::info("compute_reachable took (sec): {}", wall_timer.sec_from_origin() - start_time_sec);
+        return *reachable;
+    }
+
+    auto was_reordering_disabled = not cudd.ReorderingStatus(nullptr);
+    cudd.AutodynEnable(CUDD_REORDER_SAME);
+
+    // the prediction can be wrong, so the reachability gets as much time as the solving took (CUDD aborts it after that)
+    auto budget_sec = max<long>(R_OPTIM_MIN_SEC, start_time_sec);
+    auto reachable = with_time_limit(cudd, (unsigned long) budget_sec * 1000,
+                                     [&]() { return reachability.compute(init, constraint); });
+    if (!reachable)
+        spdlog::info("compute_reachable: exceeded the time budget of {} sec, using no don't-cares", budget_sec);
+
+    if (was_reordering_disabled)
+        cudd.AutodynDisable();
+
+    spdlog::info("compute_reachable took (sec): {}", wall_timer.sec_from_origin() - start_time_sec);
+    return reachable.value_or(cudd.bddOne());
+}
 
-    auto getCuddIdxState       = [&](int s) { return (int)(NOF_SIGNALS + s); };
-    auto getCuddIdxPrimedState = [&](int s) { return (int)(NOF_SIGNALS + aut->num_states() + s); };
 
-    vector<BDD> states;
-    vector<BDD> primedStates;
-    for (auto s = 0; s < (int)aut->num_states(); ++s)
+BDD sdf::GameSolver::extract_output_func(const BDD& strategy, const BDD& c, const vector<BDD>& others, const BDD& reachable,
+                                         AbstractionHints& abstraction_hints)
+{
+    auto c_name = inputs_outputs[c.NodeReadIndex()].ap_name();
+    spdlog::info("extracting BDD model for {}...", c_name);
+    // dumpBddAsDot(cudd, c, c_name);
+
+    BDD c_arena;
+    if (!others.empty())
     {
-        states.push_back(cudd.bddVar(getCuddIdxState(s)));
-        primedStates.push_back(cudd.bddVar(getCuddIdxPrimedState(s)));
+        BDD others_cube = cudd.computeCube(others);
+        c_arena = strategy.ExistAbstract(others_cube);
     }
+    else //no other signals left
+        c_arena = strategy;
+
+    // Now we have: c_arena(t,u,c) = ∃c_others: nondet(t,u,c)
+    // (i.e., c_arena talks about this particular c, about t and u)
+
+    BDD c_can_be_true = c_arena.Cofactor(c);
+    BDD c_can_be_false = c_arena.Cofactor(~c);
 
-    vector<BDD> inp_out_state_vars = a_union_b(states, a_union_b(get_controllable_vars_bdds(), get_uncontrollable_vars_bdds()));
-    BDD varsCube_to_quantify = cudd.bddComputeCube(inp_out_state_vars.data(), nullptr, (int)inp_out_state_vars.size());
+    c_arena = cudd.bddZero();  // killing node refs
 
-    // dumpBddAsDot(cudd, varsCube_to_quantify, "cube_to_quantify");
+    BDD c_must_be_true = ~c_can_be_false & c_can_be_true;
+    BDD c_must_be_false = c_can_be_false & ~c_can_be_true;
+    // Note that we cannot use `c_must_be_true = ~c_can_be_false`,
+    // since the negation can cause including tuples (t,i,o) that violate non_det_strategy.
 
-    BDD reach = init;
-    for (auto i = 0; ; ++i)
+    c_can_be_true = c_can_be_false = cudd.bddZero();  // killing node refs
+
+    return tuning.extract_method == ExtractMethod::best
+           ? extract_one_func_best(cudd, c_must_be_true, c_must_be_false, reachable, abstraction_hints)
+           : extract_one_func(cudd, tuning.extract_method, c_must_be_true, c_must_be_false, reachable, abstraction_hints);
+}
+
+
+hmap<uint,BDD> sdf::GameSolver::extract_output_funcs_in_order(BDD strategy, const vector<BDD>& order, const BDD& reachable,
+                                                              AbstractionHints& abstraction_hints)
+{
+    hmap<uint,BDD> model_by_cuddidx;
+
+    for (size_t i = 0; i < order.size(); ++i)
     {
-        spdlog::info("compute_reachable: iteration {}: node count: {}", i, cudd.ReadNodeCount());
-        // dumpBddAsDot(cudd, reach, "reach" + to_string(i));
+        const auto& c = order[i];
+        auto c_model = extract_output_func(strategy, c, vector<BDD>(order.begin() + (long)i + 1, order.end()), reachable,
+                                           abstraction_hints);
+        model_by_cuddidx[c.NodeReadIndex()] = c_model;
+        strategy = strategy.Compose(c_model, (int)c.NodeReadIndex());
+
+        // Note: we could re-compute the set of reachable states after each concretisation
+        // (the reachable set shrinks as we concretize output functions), but
+        // 1. it is expensive
+        // 2. does not seem to yield substantial circuit reduction
+    }
+
+    return model_by_cuddidx;
+}
+
 
-        BDD reach_prev = reach;
-        reach |= reach.AndAbstract(T, varsCube_to_quantify).SwapVariables(states, primedStates);  // SwapVariables results in unpriming of the state variables in the bdd
+hmap<uint,BDD> sdf::GameSolver::extract_output_funcs_greedily(BDD strategy, vector<BDD> order, const BDD& reachable,
+                                                              AbstractionHints& abstraction_hints,
+                                                              const WallTimer& budget_timer, uint budget_sec)
+{
+    hmap<uint,BDD> model_by_cuddidx;
 
-        if (reach == cudd.bddOne())
-            spdlog::info("compute_reachable: EVERYTHING is reachable");
+    while (!order.empty())
+    {
+        if (budget_timer.sec_from_origin() >= budget_sec)
+        {
+            spdlog::info("extract model: the greedy order exceeded {} sec, the remaining {} outputs go in the fixed order",
+                         budget_sec, order.size());
+            for (const auto& [cuddIdx, func]: extract_output_funcs_in_order(strategy, order, reachable, abstraction_hints))
+                model_by_cuddidx[cuddIdx] = func;
+            break;
+        }
 
-        if (reach_prev == reach)
+        optional<size_t> best;
+        BDD best_model;
+        for (size_t j = 0; j < order.size(); ++j)
         {
-            spdlog::info("compute_reachability took (sec): {}", timer.sec_from_origin() - start_time_sec);
-            return reach;
+            auto others = order;
+            others.erase(others.begin() + (long)j);
+            auto c_model = extract_output_func(strategy, order[j], others, reachable, abstraction_hints);
+            if (!best || c_model.nodeCount() < best_model.nodeCount())
+            {
+                best = j;
+                best_model = c_model;
+            }
         }
+
+        const auto c = order[*best];
+        spdlog::info("extract model: the greedy order takes {} ({} nodes)",
+                     inputs_outputs[c.NodeReadIndex()].ap_name(), best_model.nodeCount());
+        model_by_cuddidx[c.NodeReadIndex()] = best_model;
+        strategy = strategy.Compose(best_model, (int)c.NodeReadIndex());
+        order.erase(order.begin() + (long)*best);
     }
+
+    return model_by_cuddidx;
 }
 
 
@@ -498,116 +759,199 @@ hmap<uint,BDD> sdf::GameSolver::extract_output_funcs()
      *     c_must_be_true  = c_can_be_true & ~c_can_be_false
      *     c_must_be_false = c_can_be_false & ~c_can_be_true
      *     ...
+     * The order of concretisation substantially affects the circuit size,
+     * but how to choose a good order is unclear: hence ExtractOrder.
      */
 
     spdlog::info("extract_output_funcs..");
 
-    hmap<uint,BDD> model_by_cuddidx;
+    auto reachable = do_reach_optim && !is_reach_optim_dropped ? compute_reachable() : cudd.bddOne();
+    AbstractionHints abstraction_hints;
 
-    vector<BDD> controls = get_controllable_vars_bdds();
+    vector<BDD> fixed_order = get_controllable_vars_bdds();
+    reverse(fixed_order.begin(), fixed_order.end());
 
-    auto reachable = cudd.bddOne();
-    if (do_reach_optim)
+    if (tuning.extract_order == ExtractOrder::fixed)
     {
-        auto was_reordering_disabled = not cudd.ReorderingStatus(nullptr);
-
-        cudd.AutodynEnable(CUDD_REORDER_SAME);
-
-        auto T = compute_monolithic_T() & non_det_strategy & ~error;
-        reachable = compute_reachable(T);
-
-        if (was_reordering_disabled)
-            cudd.AutodynDisable();
+        BDD strategy = non_det_strategy;
+        non_det_strategy = cudd.bddZero();  // killing node refs
+        return extract_output_funcs_in_order(strategy, fixed_order, reachable, abstraction_hints);
     }
 
-    // the order of concretisation substantially affects the circuit size,
-    // but how to choose a good order is unclear
-
-    /*
-    std::sort(controls.begin(), controls.end(),
-              [&](const BDD& c1, const BDD& c2)
-              {
-                  return inputs_outputs[c1.NodeReadIndex()].ap_name() < inputs_outputs[c2.NodeReadIndex()].ap_name();
-              });
-    */
+    WallTimer budget_timer;
+    if (tuning.extract_order == ExtractOrder::greedy)
+        return extract_output_funcs_greedily(non_det_strategy, fixed_order, reachable, abstraction_hints,
+                                             budget_timer, EXTRACT_ORDER_SEC);
 
-    while (!controls.empty())
+    // ExtractOrder::search: the fixed order always completes, then the others while the budget lasts
+    auto model_size = [&](const hmap<uint,BDD>& model)
     {
-        BDD c = controls.back(); controls.pop_back();
+        vector<BDD> funcs;
+        for (const auto& [cuddIdx, func]: model)
+            funcs.push_back(func);
+        return cudd.nodeCount(funcs);
+    };
 
-        auto c_name = inputs_outputs[c.NodeReadIndex()].ap_name();
-        spdlog::info("extracting BDD model for {}...", c_name);
-        // dumpBddAsDot(cudd, c, c_name);
+    auto best_model = extract_output_funcs_in_order(non_det_strategy, fixed_order, reachable, abstraction_hints);
+    auto best_size = model_size(best_model);
+    spdlog::info("extract model: the fixed order: {} nodes", best_size);
 
-        BDD c_arena;
-        if (!controls.empty())
+    auto try_order = [&](const string& name, const function<hmap<uint,BDD>()>& extract)
+    {
+        if (budget_timer.sec_from_origin() >= EXTRACT_ORDER_SEC)
+        {
+            spdlog::info("extract model: no time left for the {} order", name);
+            return;
+        }
+        auto model = extract();
+        auto size = model_size(model);
+        spdlog::info("extract model: the {} order: {} nodes", name, size);
+        if (size < best_size)
         {
-            BDD others_cube = cudd.bddComputeCube(controls.data(), nullptr, (int)controls.size());
-            c_arena = non_det_strategy.ExistAbstract(others_cube);
+            best_model = model;
+            best_size = size;
         }
-        else //no other signals left
-            c_arena = non_det_strategy;
+    };
 
-        // Now we have: c_arena(t,u,c) = ∃c_others: nondet(t,u,c)
-        // (i.e., c_arena talks about this particular c, about t and u)
+    if (fixed_order.size() > 1)
+    {
+        auto reversed_order = vector<BDD>(fixed_order.rbegin(), fixed_order.rend());
+        try_order("reversed",
+                  [&]() { return extract_output_funcs_in_order(non_det_strategy, reversed_order, reachable, abstraction_hints); });
+        try_order("greedy",
+                  [&]() { return extract_output_funcs_greedily(non_det_strategy, fixed_order, reachable, abstraction_hints,
+                                                               budget_timer, EXTRACT_ORDER_SEC); });
+    }
 
-        BDD c_can_be_true = c_arena.Cofactor(c);
-        BDD c_can_be_false = c_arena.Cofactor(~c);
+    return best_model;
+}
 
-        c_arena = cudd.bddZero();  // killing node refs
 
-//        BDD c_model = extract_one_func_via_squeeze(cudd, c_can_be_true, c_can_be_false);
+static int is_flag_set(const void* flag)
+{
+    return ((const atomic<bool>*) flag)->load();
+}
 
-        BDD c_model = extract_one_func_via_abstraction(cudd, c_can_be_true, c_can_be_false, reachable);
-        c_can_be_true = c_can_be_false = cudd.bddZero();  // killing refs if they weren't killed before
 
-        model_by_cuddidx[c.NodeReadIndex()] = c_model;
+static void on_out_of_memory(size_t size)
+{
+    // (the operation then fails with CUDD_MEMORY_OUT, see synthesize)
+    spdlog::warn("CUDD could not allocate {} bytes", size);
+}
 
-        non_det_strategy = non_det_strategy.Compose(c_model, (int)c.NodeReadIndex());
 
-        // Note: we could re-compute the set of reachable states after each concretisation, but
-        // 1. it is expensive
-        // 2. does not seem to yield substantial circuit reduction
-        //
-        // if (do_reach_optim)
-        // {
-        //     T = T.Compose(c_model, (int)c.NodeReadIndex());
-        //     reachable = compute_reachable(T);  // the reachable set shrinks as we concretize output functions
-        // }
-    }
+static void on_timeout(DdManager* manager, void*)
+{
+    // (the operation then fails with CUDD_TIMEOUT_EXPIRED, and the caller that set the limit takes its cheaper path)
+    spdlog::info("CUDD: the time limit of {} ms expired", Cudd_ReadTimeLimit(manager));
+}
 
-    return model_by_cuddidx;
+
+void sdf::GameSolver::throw_if_cancelled() const
+{
+    if (cancel_flag != nullptr && cancel_flag->load())
+        throw logic_error("cancelled");
 }
 
 
-void init_cudd(Cudd& cudd)
+void sdf::GameSolver::init_cudd()
 {
     cudd.Srandom(827464282);  // for reproducibility
-    cudd.AutodynEnable(CUDD_REORDER_SIFT);
+    if (tuning.reorder_policy == ReorderPolicy::sift)
+        cudd.AutodynEnable(CUDD_REORDER_SIFT);
+    else if (tuning.reorder_policy == ReorderPolicy::adaptive)
+    {
+        reordering = make_unique<AdaptiveReordering>(cudd);
+        reordering->start_phase("fixpoint");
+    }
 //    cudd.EnableReorderingReporting();
+    if (cancel_flag != nullptr)
+        cudd.RegisterTerminationCallback(is_flag_set, (void*) cancel_flag);
+    Cudd_RegisterTimeoutHandler(cudd.getManager(), on_timeout, nullptr);
+    if (tuning.memory_mb > 0)
+    {
+        cudd.SetMaxMemory((size_t) tuning.memory_mb << 20);
+        Cudd_RegisterOutOfMemoryCallback(cudd.getManager(), on_out_of_memory);
+    }
 }
 
 
-bool sdf::GameSolver::check_realizability()
+bool sdf::GameSolver::is_out_of_memory() const
+{
+    auto error_code = cudd.ReadErrorCode();
+    return error_code == CUDD_MEMORY_OUT || error_code == CUDD_MAX_MEM_EXCEEDED;
+}
+
+
+bool sdf::GameSolver::is_under_memory_pressure() const
+{
+    return tuning.memory_mb > 0 &&
+           (double) cudd.ReadMemoryInUse() > MEMORY_PRESSURE_RATIO * (double) ((size_t) tuning.memory_mb << 20);
+}
+
+
+bool sdf::GameSolver::degrade_for_memory()
 {
-    init_cudd(cudd);
+    if (!memory_fallbacks.empty())
+        return false;
+
+    auto take = [&](const string& fallback)
+    {
+        spdlog::warn("memory ({} MB in use of {} MB): {}", cudd.ReadMemoryInUse() >> 20, tuning.memory_mb, fallback);
+        memory_fallbacks.push_back(fallback);
+    };
+
+    if (do_reach_optim)
+    {
+        is_reach_optim_dropped = true;
+        take("no reachability optimization");
+    }
+    init = error = cudd.bddZero();
+    take("released init and error");
 
-    /* The CUDD-variables index is as follows:
-     * first come inputs and outputs, ordered accordingly,
-     * then come variables of automaton states
-     * (thus, cuddIdx = state + NOF_SIGNALS) */
+    cudd.ReduceHeap(CUDD_REORDER_SIFT);  // (collects the garbage first)
+    take("garbage collection and reordering");
 
+    tuning.extract_method = ExtractMethod::squeeze;
+    tuning.extract_order = ExtractOrder::fixed;
+    take("squeeze extraction in the fixed order");
+    return true;
+}
+
+
+/* The CUDD-variables index is as follows:
+ * first come inputs and outputs, ordered accordingly,
+ * then come variables of automaton states
+ * (thus, cuddIdx = state + NOF_SIGNALS) */
+
+void sdf::GameSolver::declare_signal_vars()
+{
     for (uint i = 0; i < inputs_outputs.size(); ++i)
     {
         cudd.bddVar(i);  // NOLINT(*-narrowing-conversions)
         cudd.pushVariableName(inputs_outputs[i].ap_name());
     }
+}
+
+
+void sdf::GameSolver::declare_state_vars()
+{
+    MASSERT((uint)cudd.ReadSize() == NOF_SIGNALS, "signal variables must be declared first");
     for (uint s = 0; s < aut->num_states(); ++s)
     {
         cudd.bddVar(s + NOF_SIGNALS);  // NOLINT(cppcoreguidelines-narrowing-conversions)
         string name = string("s") + to_string(s);
         cudd.pushVariableName(name);
     }
+}
+
+
+bool sdf::GameSolver::check_realizability()
+{
+    init_cudd();
+
+    declare_signal_vars();
+    declare_state_vars();
 
     timer.sec_restart();
     build_init_state_bdd();
@@ -615,6 +959,12 @@ bool sdf::GameSolver::check_realizability()
     build_error_bdd();
     log_time("creating transition relation");
 
+    if (tuning.resume && resume_from_checkpoint())
+    {
+        log_time("resuming from the checkpoint");
+        return !win_region.IsZero();
+    }
+
     win_region = calc_win_region();
     log_time("calc_win_region");
 
@@ -622,6 +972,102 @@ bool sdf::GameSolver::check_realizability()
 }
 
 
+static string get_checkpoint_name(const string& kind, uint cuddIdx)
+{
+    return kind + " " + to_string(cuddIdx);
+}
+
+
+/** the BDDs that define the game: a checkpoint is of this game iff they are the same */
+static vector<pair<string, BDD>> get_checkpoint_of_game(const BDD& init, const BDD& error, const hmap<uint, BDD>& pre_trans_func)
+{
+    vector<pair<string, BDD>> bdd_by_name = {{"init", init}, {"error", error}};
+    for (const auto& [cuddIdx, func]: pre_trans_func)
+        bdd_by_name.emplace_back(get_checkpoint_name("latch", cuddIdx), func);
+    return bdd_by_name;
+}
+
+
+bool sdf::GameSolver::resume_from_checkpoint()
+{
+    // first, only the BDDs of the game, in the current order: the checkpoint may be of another game,
+    // then it is not worth reordering the manager and building all its nodes
+    auto game = get_checkpoint_of_game(init, error, pre_trans_func);
+    vector<string> game_names;
+    for (const auto& [name, bdd]: game)
+        game_names.push_back(name);
+    auto game_by_name = load_bdds(cudd, tuning.checkpoint_file, game_names, false);
+    bool is_of_this_game = game_by_name &&
+                           all_of(game.begin(), game.end(),
+                                  [&](const pair<string, BDD>& named) { return game_by_name->count(named.first) && game_by_name->at(named.first) == named.second; });
+    game_by_name.reset();
+
+    auto bdd_by_name = is_of_this_game ? load_bdds(cudd, tuning.checkpoint_file, {"win_region", "non_det_strategy"}) : nullopt;
+    if (!bdd_by_name || !bdd_by_name->count("win_region") || !bdd_by_name->count("non_det_strategy"))
+    {
+        spdlog::warn("no checkpoint of this game in {}, solving from scratch", tuning.checkpoint_file);
+        return false;
+    }
+
+    is_resumed = true;
+    win_region = bdd_by_name->at("win_region");
+    non_det_strategy = bdd_by_name->at("non_det_strategy");
+    bdd_by_name.reset();
+
+    // (the output functions file is removed whenever the game file is rewritten, hence it is of this game)
+    auto output_by_name = tuning.re_extract ? nullopt : load_bdds(cudd, tuning.checkpoint_file + CHECKPOINT_OUTPUTS_SUFFIX);
+    auto controls = get_controllable_vars_bdds();
+    bool has_all_outputs = output_by_name &&
+                           all_of(controls.begin(), controls.end(),
+                                  [&](const BDD& c) { return output_by_name->count(get_checkpoint_name("output", c.NodeReadIndex())) > 0; });
+    if (has_all_outputs)
+    {
+        for (const auto& c: controls)
+            outModel_by_cuddIdx[c.NodeReadIndex()] = output_by_name->at(get_checkpoint_name("output", c.NodeReadIndex()));
+        spdlog::info("resumed the winning region, the strategy, and the output functions");
+    }
+    else
+        spdlog::info("resumed the winning region and the strategy");
+    return true;
+}
+
+
+void sdf::GameSolver::save_checkpoint_of_strategy()
+{
+    if (tuning.checkpoint_file.empty())
+        return;
+    auto bdd_by_name = get_checkpoint_of_game(init, error, pre_trans_func);
+    bdd_by_name.insert(bdd_by_name.end(), {{"win_region", win_region}, {"non_det_strategy", non_det_strategy}});
+    save_bdds(cudd, bdd_by_name, tuning.checkpoint_file);
+    filesystem::remove(tuning.checkpoint_file + CHECKPOINT_OUTPUTS_SUFFIX);  // (of another game or strategy)
+    log_time("saving the checkpoint");
+}
+
+
+void sdf::GameSolver::save_checkpoint_of_outputs()
+{
+    if (tuning.checkpoint_file.empty())
+        return;
+    // (the output functions are over the game variables: the primed ones of Reachability, above them, are not saved)
+    vector<pair<string, BDD>> bdd_by_name;
+    for (const auto& [cuddIdx, func]: outModel_by_cuddIdx)
+        bdd_by_name.emplace_back(get_checkpoint_name("output", cuddIdx), func);
+    save_bdds(cudd, bdd_by_name, tuning.checkpoint_file + CHECKPOINT_OUTPUTS_SUFFIX);
+    log_time("saving the output functions");
+}
+
+
+string sdf::GameSolver::spill_strategy()
+{
+    if (!tuning.checkpoint_file.empty())
+        return tuning.checkpoint_file;  // (saved, or resumed from, by now)
+    auto file_name = (filesystem::temp_directory_path() /
+                      ("sdf-strategy-" + to_string(getpid()) + "-" + to_string((uintptr_t) this))).string();
+    save_bdds(cudd, {{"non_det_strategy", non_det_strategy}}, file_name);
+    return file_name;
+}
+
+
 aiger* sdf::GameSolver::synthesize()
 {
     if (!check_realizability())
@@ -630,13 +1076,24 @@ aiger* sdf::GameSolver::synthesize()
         return nullptr;
     }
 
+    nof_game_vars = cudd.ReadSize();
+
     // now we have win_region and compute a nondet strategy
 
-    cudd.AutodynDisable();  // TODO: properly evaluate: disabling re-ordering greatly helps on some examples (arbiter, load_balancer), but on others (prioritised_arbiter) it worsens things.
+    // disabling re-ordering greatly helps on some examples (arbiter, load_balancer), but on others (prioritised_arbiter) it worsens things
+    // (the portfolio mode tries both, the adaptive policy disables it once it stops paying off)
+    if (reordering)
+        reordering->start_phase("extraction");
+    else if (!tuning.reorder_in_extraction)
+        cudd.AutodynDisable();
 
-    non_det_strategy = get_nondet_strategy();    // note: this introduces a really lot of BDD nodes
-    log_time("get_nondet_strategy");
-    spdlog::info("BDD node count after get_nondet_strategy: {}", cudd.ReadNodeCount());
+    if (!is_resumed)
+    {
+        non_det_strategy = get_nondet_strategy();    // note: this introduces a really lot of BDD nodes
+        log_time("get_nondet_strategy");
+        spdlog::info("BDD node count after get_nondet_strategy: {}", cudd.ReadNodeCount());
+        save_checkpoint_of_strategy();
+    }
 
     // cleaning non-used BDDs
     win_region = cudd.bddZero();
@@ -648,9 +1105,38 @@ aiger* sdf::GameSolver::synthesize()
 
     // note: pre_trans_func is needed to define how latches evolve in the impl (anyway, pre_trans_func is small compared to output functions)
 
-    outModel_by_cuddIdx = extract_output_funcs();
-    log_time("extract_output_funcs");
-    spdlog::info("BDD node count after extract_output_funcs: {}", cudd.ReadNodeCount());
+    if (!outModel_by_cuddIdx.empty())
+        spdlog::info("the output functions are from the checkpoint, skipping the extraction");
+    else if (tuning.anytime_sec > 0)
+        return synthesize_anytime();
+    else
+    {
+        if (is_under_memory_pressure())
+            degrade_for_memory();
+        bool is_strategy_kept = tuning.extract_order != ExtractOrder::fixed;  // (the fixed order releases it)
+        auto strategy_file = !is_strategy_kept && tuning.memory_mb > 0 ? spill_strategy() : "";
+        try
+        {
+            outModel_by_cuddIdx = extract_output_funcs();
+        }
+        catch (const logic_error&)
+        {
+            if (!is_out_of_memory() || (!is_strategy_kept && strategy_file.empty()))
+                throw;
+            cudd.ClearErrorCode();
+            spdlog::warn("the extraction ran out of memory");
+            if (!degrade_for_memory())
+                throw;
+            if (!is_strategy_kept)
+                non_det_strategy = load_bdds(cudd, strategy_file, {"non_det_strategy"}, false)->at("non_det_strategy");
+            outModel_by_cuddIdx = extract_output_funcs();
+        }
+        if (!strategy_file.empty() && strategy_file != tuning.checkpoint_file)
+            filesystem::remove(strategy_file);
+        log_time("extract_output_funcs");
+        spdlog::info("BDD node count after extract_output_funcs: {}", cudd.ReadNodeCount());
+        save_checkpoint_of_outputs();
+    }
 
     // cleaning non-used BDDs
     non_det_strategy = cudd.bddZero();
@@ -658,26 +1144,114 @@ aiger* sdf::GameSolver::synthesize()
 
     spdlog::info("BDD node count of det strategy: {}", cudd.ReadNodeCount());
     auto elapsed_sec = time_limit_sec - timer.sec_from_origin();
-    if (elapsed_sec > 100)
-    {   // leave 100sec for writing to AIGER
-        auto spare_time_sec = elapsed_sec - 100;
-        cudd.ResetStartTime();
-        cudd.IncreaseTimeLimit((unsigned long) (spare_time_sec * 1000));
-        cudd.ReduceHeap(CUDD_REORDER_SIFT_CONVERGE);
-        cudd.UnsetTimeLimit();
-        cudd.AutodynDisable();  // just in case -- cudd hangs on timeout
-    }
+    if (elapsed_sec > 100)  // leave 100sec for writing to AIGER
+        reorder_within((unsigned long) (elapsed_sec - 100));
     log_time("reordering before aigerizing");
     spdlog::info("BDD node count of det strategy after reordering: {}", cudd.ReadNodeCount());
 
     model_to_aiger();
     log_time("model_to_aiger");
     spdlog::info("circuit size: {}", (aiger_lib->num_ands + aiger_lib->num_latches));
+    if (!memory_fallbacks.empty())
+        spdlog::warn("memory: the fallbacks taken: {}", join(", ", memory_fallbacks));
 
     return aiger_lib;
 }
 
 
+void sdf::GameSolver::reorder_within(unsigned long sec)
+{
+    if (tuning.reorder_policy == ReorderPolicy::off)
+        return;
+    if (reordering && !reordering->is_paying_off())
+    {
+        spdlog::info("the reordering did not pay off in the extraction, skipping the final one");
+        return;
+    }
+
+    cudd.ResetStartTime();
+    cudd.IncreaseTimeLimit(sec * 1000);
+    cudd.ReduceHeap(reordering ? reordering->get_final_method() : CUDD_REORDER_SIFT_CONVERGE);
+    cudd.UnsetTimeLimit();
+    cudd.AutodynDisable();  // just in case -- cudd hangs on timeout
+}
+
+
+aiger* sdf::GameSolver::synthesize_anytime()
+{
+    auto left_sec = [&]()
+    {
+        auto elapsed_sec = (uint) wall_timer.sec_from_origin();
+        return elapsed_sec < tuning.anytime_sec ? tuning.anytime_sec - elapsed_sec : 0u;
+    };
+
+    // the first model: restrict in the fixed order, without the reachable states, without reordering
+    auto requested_tuning = tuning;
+    tuning.extract_method = ExtractMethod::restrict;
+    vector<BDD> fixed_order = get_controllable_vars_bdds();
+    reverse(fixed_order.begin(), fixed_order.end());
+    AbstractionHints abstraction_hints;
+    outModel_by_cuddIdx = extract_output_funcs_in_order(non_det_strategy, fixed_order, cudd.bddOne(), abstraction_hints);
+    tuning = requested_tuning;
+
+    model_to_aiger();
+    aiger* first_model = aiger_lib;
+    auto first_size = first_model->num_ands + first_model->num_latches;
+    log_time("anytime: the first model");
+    spdlog::info("anytime: the first model: circuit size: {}", first_size);
+
+    // (the next model is built from scratch)
+    aiger_lib = nullptr;
+    next_lit = 2;
+    aiger_by_cudd.clear();
+    cache.clear();
+
+    // the improvement: the requested extraction and reordering, within the time left
+    if (left_sec() == 0)
+    {
+        spdlog::info("anytime: no time left to improve the model");
+        return first_model;
+    }
+    try
+    {
+        cudd.ResetStartTime();
+        cudd.SetTimeLimit((unsigned long) left_sec() * 1000);
+        outModel_by_cuddIdx = extract_output_funcs();
+        cudd.UnsetTimeLimit();
+        save_checkpoint_of_outputs();
+    }
+    catch (const logic_error&)
+    {
+        cudd.UnsetTimeLimit();
+        if (cudd.ReadErrorCode() != CUDD_TIMEOUT_EXPIRED && !(tuning.memory_mb > 0 && is_out_of_memory()))
+            throw;  // (e.g., cancelled)
+        spdlog::info("anytime: the extraction {}, keeping the first model",
+                     is_out_of_memory() ? "ran out of memory" : "exceeded " + to_string(tuning.anytime_sec) + " sec");
+        cudd.ClearErrorCode();
+        return first_model;
+    }
+    log_time("extract_output_funcs");
+
+    non_det_strategy = cudd.bddZero();
+    init = error = cudd.bddZero();
+    if (left_sec() > 0)
+        reorder_within(left_sec());
+    log_time("reordering before aigerizing");
+
+    model_to_aiger();
+    auto size = aiger_lib->num_ands + aiger_lib->num_latches;
+    log_time("model_to_aiger");
+    spdlog::info("anytime: the improved model: circuit size: {}", size);
+    if (size >= first_size)
+    {
+        aiger_reset(aiger_lib);
+        return aiger_lib = first_model;
+    }
+    aiger_reset(first_model);
+    return aiger_lib;
+}
+
+
 void sdf::GameSolver::model_to_aiger()
 {
     aiger_lib = aiger_init();
@@ -731,11 +1305,11 @@ void sdf::GameSolver::model_to_aiger()
 
     // By default, aiger latches are initialized to 0,
     // but the latch of the initial state has to start in 1, so ensure this:
-    uint s0 = aut->get_init_state_number();
-    uint s0_asCuddIdx = s0 + NOF_SIGNALS;
-    uint s0_asAigerLit = aiger_by_cudd[s0_asCuddIdx];
-    aiger_add_reset(aiger_lib, s0_asAigerLit, 1);
-    MASSERT(contains(processed, s0_asCuddIdx), "states must depend on the initial state");
+    for (auto s0_asCuddIdx : init_latches)
+        if (contains(processed, s0_asCuddIdx))
+            aiger_add_reset(aiger_lib, aiger_by_cudd[s0_asCuddIdx], 1);
+    MASSERT(any_of(init_latches.begin(), init_latches.end(), [&](uint l) { return contains(processed, l); }),
+            "states must depend on the initial state");
 }
 
 
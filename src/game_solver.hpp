@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <utility>
 #include <vector>
+#include <set>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -23,12 +27,22 @@ extern "C"
 #include <cudd.h>
 #include <cuddObj.hh>
 #include "my_assert.hpp"
+#include "reordering.hpp"
+#include "solver_tuning.hpp"
 #include "timer.hpp"
 
 
 namespace sdf
 {
 
+const double R_OPTIM_COST_RATIO = 10;  // the reachability optimization is skipped when one image step is predicted to cost more
+                                       // than this many model extractions (see GameSolver::compute_reachable)
+const uint R_OPTIM_MIN_SEC = 10;       // the time budget of the reachability optimization: as long as the solving took, but at least this
+const uint R_OPTIM_EXPLICIT_BOUND = 20000;  // the explicit reachability gives up (for the symbolic one) after this many macro-states
+const uint EXTRACT_ABSTRACTION_SEC = 5;     // ExtractMethod::abstraction: after this long on one output, no more variables are tried
+const double MEMORY_PRESSURE_RATIO = 0.7;   // SolverTuning::memory_mb: the extraction takes the cheaper paths when CUDD uses more than this share
+const std::string CHECKPOINT_OUTPUTS_SUFFIX = ".outputs";  // NOLINT(cert-err58-cpp)  // the output functions go to checkpoint_file + this
+
 /**
  * Backwards-exploration game solver using BDDs.
  */
@@ -55,22 +69,46 @@ public:
         inputs_outputs.insert(inputs_outputs.end(), outputs.begin(), outputs.end());
     }
 
+    virtual ~GameSolver() = default;
+
     /**
      * @return true iff the game realizable
      * (can be called only once!)
      */
-    bool check_realizability();
+    virtual bool check_realizability();
     /**
      * @return model in the AIGER format if the game is realizable otherwise return NULL
      * (Beware of internal state: can be called only once!)
      */
     aiger* synthesize();
 
+    /**
+     * A cheap witness of the loss (call after check_realizability returned false):
+     * @return the SCCs (as in spot::scc_info of the UCW) whose visit budget got exhausted in the losing plays,
+     *         or nullopt if the solver cannot tell (e.g., it works on the k-reduced automaton)
+     */
+    virtual std::optional<std::set<uint>> get_exhausted_sccs() { return std::nullopt; }
+
+    /**
+     * Once the flag is set, the BDD operations are aborted (CUDD calls its termination handler, which throws).
+     * (call before check_realizability/synthesize)
+     */
+    void set_cancel_flag(const std::atomic<bool>* flag) { cancel_flag = flag; }
+
+    /** (call before synthesize) */
+    void set_tuning(const SolverTuning& tuning_) { tuning = tuning_; }
+
+    /** @return true iff the last CUDD operation failed for the lack of memory (then it threw) */
+    bool is_out_of_memory() const;
+
+    /** @return the cheaper paths taken under memory pressure (SolverTuning::memory_mb), in the order taken */
+    const std::vector<std::string>& get_memory_fallbacks() const { return memory_fallbacks; }
+
 private:
     GameSolver(const GameSolver& other);
     GameSolver& operator=(const GameSolver& other);
 
-private:
+protected:
     const bool is_moore;
     const std::vector<spot::formula> inputs;             // (ordered)
     const std::vector<spot::formula> outputs;            // (ordered)
@@ -80,18 +118,35 @@ private:
     const bool do_reach_optim;
 
     const uint time_limit_sec;
+    const std::atomic<bool>* cancel_flag = nullptr;
+    SolverTuning tuning;
 
-private:
+protected:
     Timer timer;
+    WallTimer wall_timer;  // (for the time budgets)
     Cudd cudd;
+    std::unique_ptr<AdaptiveReordering> reordering;  // (ReorderPolicy::adaptive only)
 
     std::unordered_map<uint, BDD> pre_trans_func;  // cudd variable index -> BDD (Note: cuddIdx = state + NOF_SIGNALS)
     BDD init;
+    std::vector<uint> init_latches;  // cudd indices of the latches that are initially 1 (the others are 0)
     BDD error;
     BDD win_region;
     BDD non_det_strategy;
     std::unordered_map<uint, BDD> outModel_by_cuddIdx;
 
+    // cudd.ReadSize() once the game is built: the signals and the latches have the smaller indices,
+    // the primed variables that Reachability adds (once, for compute_reachable) come after them
+    uint nof_game_vars = 0;
+    bool is_reach_optim_dropped = false;
+    uint explicit_reach_bound = R_OPTIM_EXPLICIT_BOUND;  // (see compute_reachable_explicitly)
+    std::vector<std::string> memory_fallbacks;
+
+    bool is_resumed = false;  // (from SolverTuning::checkpoint_file)
+
+    std::unordered_map<int, uint> cuddIdx_by_spot_var;  // spot (BuDDy) variable of a signal -> cudd index
+    std::unordered_map<int, BDD> cudd_by_spot_id;       // memo of translate_label: spot bdd id -> cudd BDD
+
 private:
     aiger* aiger_lib = nullptr;
     uint next_lit = 2;  // next available literal to be used in aiger; incremented by 2
@@ -99,24 +154,102 @@ private:
     std::unordered_map<DdNode*, uint> cache;        // used in AIGER model construction
 
 
-private:
+protected:
     std::vector<BDD> get_controllable_vars_bdds();
     std::vector<BDD> get_uncontrollable_vars_bdds();
 
-    void build_error_bdd();
+    void init_cudd();
+
+    void declare_signal_vars();
+
+    virtual void declare_state_vars();
+
+    BDD translate_label(const bdd& label);  // spot label (over inputs and outputs) -> cudd BDD
+
+    virtual void build_error_bdd();
 
-    void build_init_state_bdd();
+    virtual void build_init_state_bdd();
 
-    void build_pre_trans_func();
+    virtual void build_pre_trans_func();
 
     BDD pre_sys(BDD dst);  // also ensures that error is not violated
 
-    BDD calc_win_region();
+    virtual BDD calc_win_region();
 
-    BDD get_nondet_strategy();
+    virtual BDD get_nondet_strategy();
 
     std::unordered_map<uint, BDD> extract_output_funcs();
 
+    /**
+     * SolverTuning::anytime_sec: first a cheap model (restrict, the fixed order, no reachable states, no reordering),
+     * then the requested extraction and the reordering within the time left;
+     * the smaller circuit of the two is returned, the first one if the second did not finish in time.
+     */
+    aiger* synthesize_anytime();
+
+    /**
+     * Load win_region and non_det_strategy (and the output functions unless SolverTuning::re_extract) from the checkpoint.
+     * (call after the game is built)
+     * @return false if there is no checkpoint of this game
+     */
+    bool resume_from_checkpoint();
+
+    /**
+     * Save the game, win_region, and non_det_strategy to SolverTuning::checkpoint_file (if set),
+     * and remove the output functions of an older checkpoint.
+     */
+    void save_checkpoint_of_strategy();
+
+    /**
+     * Save the output functions to their own file next to the checkpoint (see CHECKPOINT_OUTPUTS_SUFFIX),
+     * so that the BDDs saved before need not be kept alive until the extraction ends.
+     */
+    void save_checkpoint_of_outputs();
+
+    /**
+     * Keep non_det_strategy on disk, for the extraction in the fixed order releases it (SolverTuning::memory_mb:
+     * then it can be reloaded to retry after the cheaper paths): in the checkpoint if any, otherwise in a temporary file.
+     * @return the file
+     */
+    std::string spill_strategy();
+
+    /** throw (as CUDD's termination callback makes the BDD operations do) once the cancel flag is set: for the loops outside CUDD */
+    void throw_if_cancelled() const;
+
+    bool is_under_memory_pressure() const;
+
+    /**
+     * The cheaper extraction (SolverTuning::memory_mb): drop the reachability optimization and release init and error,
+     * collect the garbage and reorder, and extract via squeeze in the fixed order.
+     * (synthesize calls it when the memory is under pressure before the extraction, and
+     * when the extraction in another order than the fixed one runs out of memory: the strategy is still there to retry with)
+     * @return false if it was already done
+     */
+    bool degrade_for_memory();
+
+    /** ReduceHeap (sifting to convergence, or as AdaptiveReordering says) for at most `sec` seconds */
+    void reorder_within(unsigned long sec);
+
+    /**
+     * @param others: the outputs not yet concretised (they are quantified away)
+     * @param abstraction_hints: see ExtractMethod::abstraction (shared by the outputs)
+     * @return the function of the output `c` allowed by `strategy`
+     */
+    BDD extract_output_func(const BDD& strategy, const BDD& c, const std::vector<BDD>& others, const BDD& reachable,
+                            std::unordered_map<uint, uint>& abstraction_hints);
+
+    /** concretise the outputs one by one, `order` says which goes first */
+    std::unordered_map<uint, BDD> extract_output_funcs_in_order(BDD strategy, const std::vector<BDD>& order, const BDD& reachable,
+                                                                std::unordered_map<uint, uint>& abstraction_hints);
+
+    /**
+     * Concretise first the output whose function is the smallest, and repeat.
+     * Once the `budget_timer` reaches `budget_sec`, the remaining outputs go as in `order`.
+     */
+    std::unordered_map<uint, BDD> extract_output_funcs_greedily(BDD strategy, std::vector<BDD> order, const BDD& reachable,
+                                                                std::unordered_map<uint, uint>& abstraction_hints,
+                                                                const WallTimer& budget_timer, uint budget_sec);
+
     std::vector<BDD> get_substitution();
 
     uint walk(DdNode *a_dd, std::set<uint>&);
@@ -132,9 +265,20 @@ private:
         return curr;
     }
 
-    BDD compute_reachable(const BDD& T);
+    /**
+     * @return the states reachable under the non-deterministic strategy:
+     *         explicitly if possible, otherwise symbolically (see Reachability),
+     *         or bddOne (no don't-cares) if that is predicted not to pay off or does not fit into the time budget
+     */
+    BDD compute_reachable();
 
-    BDD compute_monolithic_T();
+    /**
+     * The latches are the automaton states, hence a reachable latch valuation is a macro-state
+     * (a single state if the automaton is deterministic): explore the macro-states from the initial one
+     * along the moves that the strategy allows, and encode them as cubes.
+     * @return nullopt if there are more than explicit_reach_bound macro-states or the latches encode something else
+     */
+    virtual std::optional<BDD> compute_reachable_explicitly();
 };
 
 
@@ -10,6 +10,8 @@
 #include "atm_helper.hpp"
 
 #include <unordered_map>
+#include <algorithm>
+#include <climits>
 
 
 using namespace std;
@@ -50,6 +52,50 @@ struct hash<kState>
 }
 
 spot::twa_graph_ptr sdf::k_reduce(const spot::twa_graph_ptr& aut, uint max_nof_visits)
+{
+    return k_reduce(aut, uniform_k_by_scc(aut, max_nof_visits));
+}
+
+
+vector<uint> sdf::uniform_k_by_scc(const spot::twa_graph_ptr& aut, uint max_k)
+{
+    return vector<uint>(spot::scc_info(aut).scc_count(), max_k);
+}
+
+
+/** @return true iff the SCC has a rejecting (accepting, in the automaton terms) state that lies on a cycle */
+static bool has_rejecting_cycles(const spot::twa_graph_ptr& aut, const spot::scc_info& scc_info, uint scc)
+{
+    if (scc_info.is_trivial(scc))
+        return false;
+    const auto& states = scc_info.states_of(scc);
+    return any_of(states.begin(), states.end(),
+                  [&](uint s) { return aut->state_is_accepting(s) && !is_acc_sink(aut, s); });
+}
+
+
+vector<uint> sdf::balanced_k_by_scc(const spot::twa_graph_ptr& aut, uint max_k)
+{
+    spot::scc_info scc_info(aut);
+
+    size_t min_size = SIZE_MAX;
+    for (uint scc = 0; scc < scc_info.scc_count(); ++scc)
+        if (has_rejecting_cycles(aut, scc_info, scc))
+            min_size = min(min_size, scc_info.states_of(scc).size());
+
+    vector<uint> k_by_scc(scc_info.scc_count(), 0);
+    for (uint scc = 0; scc < scc_info.scc_count(); ++scc)
+        if (has_rejecting_cycles(aut, scc_info, scc))
+        {
+            // |scc| * (k+1) <= min_size * (max_k+1)
+            auto k = (long) (min_size * (max_k + 1) / scc_info.states_of(scc).size()) - 1;
+            k_by_scc[scc] = (uint) min((long) max_k, max(1l, k));
+        }
+    return k_by_scc;
+}
+
+
+spot::twa_graph_ptr sdf::k_reduce(const spot::twa_graph_ptr& aut, const vector<uint>& k_by_scc)
 {
     MASSERT(aut->is_sba().is_true(), "currently, only SBA is supported");
 
@@ -58,15 +104,17 @@ spot::twa_graph_ptr sdf::k_reduce(const spot::twa_graph_ptr& aut, uint max_nof_v
     k_aut->copy_ap_of(aut);
 
     spot::scc_info scc_info(aut);
+    MASSERT(k_by_scc.size() == scc_info.scc_count(), "the bounds must be given for every SCC");
 
     // `state` is a state of `aut`, `kstate` is a state of `k_aut`
     unordered_map<pair<uint, uint>, kState, pair_hash<uint,uint>> kstate_by_state_k;
     vector<pair<kState, uint>> kstate_state_to_process;
 
-    auto init_kstate = kState(k_aut->new_state(), max_nof_visits);
+    auto init_k = k_by_scc[scc_info.scc_of(aut->get_init_state_number())];
+    auto init_kstate = kState(k_aut->new_state(), init_k);
     k_aut->set_init_state(init_kstate.state);
 
-    kstate_by_state_k.emplace(make_pair(aut->get_init_state_number(), max_nof_visits),
+    kstate_by_state_k.emplace(make_pair(aut->get_init_state_number(), init_k),
                               init_kstate);
 
     auto acc_ksink = kState(k_aut->new_state(), (uint) -1);
@@ -84,7 +132,7 @@ spot::twa_graph_ptr sdf::k_reduce(const spot::twa_graph_ptr& aut, uint max_nof_v
             int dst_k = scc_info.scc_of(t.src) == scc_info.scc_of(t.dst)
                         ?
                         (int) src_kstate.k - aut->state_is_accepting(t.src)
-                        : (int) max_nof_visits;
+                        : (int) k_by_scc[scc_info.scc_of(t.dst)];
 
             if (dst_k == -1 || is_acc_sink(aut, t.dst))
             {
@@ -4,6 +4,8 @@
     #include <spot/twa/twagraph.hh>
 #undef BDD
 
+#include <vector>
+
 
 namespace sdf
 {
@@ -16,4 +18,24 @@ namespace sdf
  */
 spot::twa_graph_ptr k_reduce(const spot::twa_graph_ptr& aut, uint max_k);
 
+/**
+ * Same as above, but every SCC has its own bound.
+ * @param k_by_scc maximal number of visits to rejecting states for each SCC of aut (indexed as in spot::scc_info(aut))
+ */
+spot::twa_graph_ptr k_reduce(const spot::twa_graph_ptr& aut, const std::vector<uint>& k_by_scc);
+
+/** @return the bound max_k for every SCC */
+std::vector<uint> uniform_k_by_scc(const spot::twa_graph_ptr& aut, uint max_k);
+
+/**
+ * The k-reduction copies an SCC with rejecting states k+1 times (the other SCCs are never copied),
+ * so the large SCCs dominate the size of the safety automaton.
+ * This heuristic keeps max_k for the smallest SCC with rejecting states,
+ * and lowers the bounds of larger SCCs so that their copies are not larger than those of the smallest one
+ * (but the bound is at least 1).
+ * The SCCs without rejecting states get 0 (their bound does not matter).
+ * Note that the result can be unrealizable for these bounds but realizable for max_k.
+ */
+std::vector<uint> balanced_k_by_scc(const spot::twa_graph_ptr& aut, uint max_k);
+
 }
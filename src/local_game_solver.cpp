@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+
+#define BDD spotBDD
+    #include <spot/twa/twagraph.hh>
+#undef BDD
+
+
+#include "local_game_solver.hpp"
+
+
+using namespace std;
+
+
+bool sdf::LocalGameSolver::is_needed(uint n)
+{
+    if (n == 0)
+        return true;
+    // the moves to losing nodes are removed, so any non-losing predecessor has a move to `n`
+    return any_of(nodes[n].preds.begin(), nodes[n].preds.end(),
+                  [&](const pair<uint, uint>& p_move) { return !nodes[p_move.first].is_losing; });
+}
+
+
+bool sdf::LocalGameSolver::solve_game()
+{
+    /**
+     * A non-expanded node is optimistically assumed to be winning.
+     * When a node is expanded, we check it and propagate backwards if it is losing.
+     * A postponed (not needed) node is pushed again when a new move to it appears,
+     * hence on termination the non-losing expanded nodes are closed under their moves,
+     * and thus describe a winning strategy.
+     */
+
+    spdlog::info("solve_game (on-the-fly)..");
+
+    vector<uint> to_expand = {0};
+    while (!to_expand.empty())
+    {
+        uint n = to_expand.back();
+        to_expand.pop_back();
+
+        if (nodes[n].is_expanded || nodes[n].is_losing || !is_needed(n))
+            continue;
+
+        expand(n);
+        for (const auto& m: nodes[n].moves)
+            if (!nodes[m.dst].is_expanded)
+                to_expand.push_back(m.dst);
+
+        if (!propagate({n}))
+        {
+            spdlog::info("solve_game: the initial macro-state is losing (explored {} of {} discovered macro-states)",
+                         count_if(nodes.begin(), nodes.end(), [](const Node& node) { return node.is_expanded; }),
+                         nodes.size());
+            return false;
+        }
+    }
+
+    spdlog::info("solve_game: the initial macro-state is winning (explored {} of {} discovered macro-states)",
+                 count_if(nodes.begin(), nodes.end(), [](const Node& node) { return node.is_expanded; }),
+                 nodes.size());
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "explicit_game_solver.hpp"
+
+
+namespace sdf
+{
+
+/**
+ * On-the-fly local game solver (in the style of OTFUR by Cassez et al.).
+ *
+ * Explores the macro-states forward from the initial one (depth-first),
+ * and re-evaluates backwards only the explored macro-states.
+ * Macro-states reachable only via moves that are already known to be losing are not explored.
+ * Stops as soon as the initial macro-state is losing,
+ * or when the explored macro-states are closed under the remaining (winning) moves.
+ */
+class LocalGameSolver : public ExplicitGameSolver
+{
+
+public:
+    LocalGameSolver(bool is_moore_,
+                    const std::unordered_set<spot::formula>& inputs_,
+                    const std::unordered_set<spot::formula>& outputs_,
+                    const spot::twa_graph_ptr& aut_,  // NOLINT(*-pass-by-value)
+                    const bool do_reach_optim,
+                    uint time_limit_sec_ = 3600) :
+        ExplicitGameSolver(is_moore_, inputs_, outputs_, aut_, do_reach_optim, time_limit_sec_)
+    { }
+
+protected:
+    /** @return true iff the node can still be reached via a move that is not known to be losing */
+    bool is_needed(uint n);
+
+    bool solve_game() override;
+};
+
+
+} // namespace sdf
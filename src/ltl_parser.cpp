@@ -1,15 +1,16 @@
 #include "ltl_parser.hpp"
+#include "tlsf_parser.hpp"
 #include "my_assert.hpp"
 #include "utils.hpp"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <tuple>
-#include <set>
 
 
 #define BDD spotBDD
     #include <spot/tl/formula.hh>
-    #include <spot/tl/parse.hh>
 //    #include <spot/tl/print.hh>
 #undef BDD
 
@@ -31,44 +32,25 @@ void assert_do_not_intersect(vector<string> &inputs, vector<string> &outputs)
 }
 
 
-string
-to_str(int rc, const string& out, const string& err)
+tuple<spot::formula, unordered_set<spot::formula>, unordered_set<spot::formula>, bool>
+sdf::parse_tlsf(const string& tlsf_file_name)
 {
-    stringstream ss;
-    ss << "rc: " << rc << endl
-       << "out: \n" << out << endl
-       << "err: \n" << err << endl;
-    return ss.str();
+    ifstream file(tlsf_file_name);
+    MASSERT(file, "could not open the file: " << tlsf_file_name);
+    stringstream text;
+    text << file.rdbuf();
+
+    return parse_tlsf_string(text.str());
 }
 
 
 tuple<spot::formula, unordered_set<spot::formula>, unordered_set<spot::formula>, bool>
-sdf::parse_tlsf(const string& tlsf_file_name)
+sdf::parse_tlsf_string(const string& tlsf_text)
 {
-    int rc;
-    string out, err;
-
-    tie(rc, out, err) = execute("syfco -f ltl -m fully -q double " + tlsf_file_name);
-    MASSERT(rc == 0 && err.empty(),
-            "syfco exited with non-zero status or non-empty stderr: \n" + to_str(rc, out, err) + "\nfile:" + tlsf_file_name);
-
-    auto parsed_formula = spot::parse_infix_psl(out);
-    if (!parsed_formula.errors.empty())
-    {
-        stringstream ss;
-        parsed_formula.format_errors(ss);
-        MASSERT(0, "Could not parse the formula: " << out << endl << ss.str());
-    }
-
-    tie(rc, out, err) = execute("syfco -ins " + tlsf_file_name);
-    MASSERT(rc == 0 && err.empty(), "syfco exited with non-zero status or non-empty stderr: " << to_str(rc, out, err));
-    auto str_inputs = split_by_space(substituteAll(out, ",", " "));
-
-    tie(rc, out, err) = execute("syfco -outs " + tlsf_file_name);
-    MASSERT(rc == 0 && err.empty(),
-            "syfco exited with non-zero status or non-empty stderr: " + to_str(rc, out, err));
-    auto str_outputs = split_by_space(substituteAll(out, ",", " "));
+    auto spec = parse_tlsf_text(tlsf_text);
 
+    auto str_inputs = spec.inputs;
+    auto str_outputs = spec.outputs;
     assert_do_not_intersect(str_inputs, str_outputs);
 
     // separate APs into inputs and outputs
@@ -80,47 +62,6 @@ sdf::parse_tlsf(const string& tlsf_file_name)
     for (const auto& s : str_outputs)
         outputs.insert(spot::formula::ap(s));
 
-    {   // checking that the formula APs are from inputs or outputs
-        set<spot::formula> aps;
-        parsed_formula.f.traverse(
-                [&aps](const spot::formula& f)
-                {
-                    if (f.is(spot::op::ap))
-                        aps.insert(f);
-                    return false;  // always continue traversing
-                });
-        for (const auto& ap : aps)
-            MASSERT(inputs.count(ap) || outputs.count(ap), "the formula mentions AP not from inputs nor outputs: " << ap);
-    }
-
-    tie(rc, out, err) = execute("syfco -g " + tlsf_file_name);
-    MASSERT(rc == 0 && err.empty(),
-            "syfco exited with non-zero status or non-empty stderr: " + to_str(rc, out, err));
-    auto out_stripped = lower(trim_spaces(out));
-    MASSERT(out_stripped == "moore" || out_stripped == "mealy", "unknown type string: " + out);
-    bool is_moore = (out_stripped == "moore");
-
-    return {parsed_formula.f, inputs, outputs, is_moore};
+    // (as with syfco, the Moore semantics does not shift the formula: only the target matters)
+    return {spec.formula, inputs, outputs, spec.is_moore_target};
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -19,4 +19,10 @@ namespace sdf
 std::tuple<spot::formula, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
 parse_tlsf(const std::string &tlsf_file_name);
 
+/**
+ * As parse_tlsf, but the TLSF specification is given as text.
+ */
+std::tuple<spot::formula, std::unordered_set<spot::formula>, std::unordered_set<spot::formula>, bool>
+parse_tlsf_string(const std::string& tlsf_text);
+
 } //namespace sdf
@@ -1,11 +1,14 @@
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include <spdlog/spdlog.h>
 #include <args.hxx>
 
 #include "utils.hpp"
 #include "synthesizer.hpp"
+#include "cli_flags.hpp"
+#include "portfolio.hpp"
 
 
 using namespace std;
@@ -39,18 +42,45 @@ int main(int argc, const char *argv[])
             (parser,
              "ra",
              "do reachability-analysis optimization during strategy determinisation (expensive);"
-             "automatically disabled when the number of states in the safety automaton > " + to_string(R_OPTIM_BOUND),
+             "automatically skipped when predicted not to pay off or when it exceeds the time the solving took",
              {'a', "ra"});
 
-    args::ValueFlagList<uint> k_list_arg
+    EngineFlags engine_flags(parser);
+
+    TuningFlags tuning_flags(parser);
+
+    args::ValueFlag<uint> deadline_arg
+            (parser,
+             "deadline",
+             "do not try new k after this many seconds (0 means no deadline). "
+             "Default: 0.",
+             {"deadline"},
+             0);
+
+    args::ImplicitValueFlag<uint> portfolio_arg
+            (parser,
+             "configs",
+             "run this many configurations in parallel processes (the translation level, reachability optimization, "
+             "reordering and extraction method vary) and take the first verdict, or the smallest model (see --grace). "
+             "Give the number as --portfolio=N; --portfolio alone uses the number of cores.",
+             {"portfolio"},
+             max(1u, thread::hardware_concurrency()));
+
+    args::ValueFlag<uint> portfolio_memory_arg
+            (parser,
+             "MB",
+             "portfolio: the memory limit of every configuration. "
+             "Default: an equal share of the physical memory.",
+             {"portfolio-memory"},
+             0);
+
+    args::ValueFlag<uint> grace_arg
             (parser,
-             "k",
-             "the maximum number of times the same bad state can be visited "
-             "(thus, it is reset between SCCs). "
-             "If you provide it several times (e.g. -k 1 -k 4 -k 8), then I will try all those values in that order. "
-             "Default: 4.",
-             {'k'},
-             {4});
+             "grace",
+             "portfolio: after the first model, wait this many seconds for smaller models. "
+             "Default: 0.",
+             {"grace"},
+             0);
 
     args::ValueFlag<string> output_name
             (parser,
@@ -79,6 +109,7 @@ int main(int argc, const char *argv[])
     try
     {
         parser.ParseCLI(argc, argv);
+        engine_flags.validate();
     }
     catch (args::Help&)
     {
@@ -108,10 +139,14 @@ int main(int argc, const char *argv[])
     // parse args
     string tlsf_file_name(tlsf_arg.Get());
     string output_file_name(output_name ? output_name.Get() : "stdout");
-    vector<uint> k_list(k_list_arg.Get());
+    vector<uint> k_list(engine_flags.k_list.Get());
     bool check_dual_spec(check_dual_flag.Get());
     bool check_real_only(check_real_only_flag.Get());
     bool do_reach_analysis(do_reach_optim_flag.Get());
+    SolverEngine engine(engine_flags.engine.Get());
+    KBoundPolicy k_policy(engine_flags.k_policy.Get());
+    uint deadline_sec(deadline_arg.Get());
+    SolverTuning tuning(tuning_flags.get_tuning());
 
     if (do_reach_analysis && (check_dual_spec || check_real_only))
     {
@@ -123,7 +158,9 @@ int main(int argc, const char *argv[])
     spdlog::info("tlsf_file: {}, check_dual_spec: {}, k: {}, output_file: {}",
                  tlsf_file_name, check_dual_spec, join(", ", k_list), output_file_name);
 
-    return sdf::run_tlsf(SpecDescr(check_dual_spec, tlsf_file_name, !check_real_only, do_reach_analysis, output_file_name),
-                         k_list);
+    auto spec_descr = SpecDescr(check_dual_spec, tlsf_file_name, !check_real_only, do_reach_analysis, output_file_name, engine, k_policy, deadline_sec, tuning);
+    if (portfolio_arg)
+        return sdf::run_portfolio(spec_descr, k_list, PortfolioDescr{portfolio_arg.Get(), portfolio_memory_arg.Get(), grace_arg.Get()});
+    return sdf::run_tlsf(spec_descr, k_list);
 }
 
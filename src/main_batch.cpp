@@ -0,0 +1,177 @@
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <args.hxx>
+
+#include "utils.hpp"
+#include "synthesizer.hpp"
+#include "cli_flags.hpp"
+#include "batch.hpp"
+#include "cluster.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+int main(int argc, const char *argv[])
+{
+    args::ArgumentParser parser("Batch synthesizer: solves many specifications (TLSF or extended HOA) on a pool of workers "
+                                "and prints one JSON line per specification");
+    parser.helpParams.width = 100;
+    parser.helpParams.helpindent = 26;
+
+    args::PositionalList<string> specs_arg
+        (parser, "specs",
+         "files with specifications (*.tlsf are TLSF, others are extended HOA) or directories with them "
+         "(not used with --connect)");
+
+    args::ValueFlag<uint> nof_workers_arg
+            (parser,
+             "workers",
+             "the number of worker processes. "
+             "Default: the number of cores.",
+             {'j', "jobs"},
+             max(1u, thread::hardware_concurrency()));
+
+    args::Flag check_dual_flag
+            (parser,
+             "dual",
+             "check the dualized specs (unrealizability; TLSF only)",
+             {'d', "dual"});
+
+    args::Flag extract_flag
+            (parser,
+             "circuit",
+             "extract the models (the circuit size is reported)",
+             {'c', "circuit"});
+
+    args::ValueFlag<string> output_dir_arg
+            (parser,
+             "dir",
+             "write the models into this directory as <spec file name>.aag (implies --circuit)",
+             {'o', "output-dir"});
+
+    args::Flag do_reach_optim_flag
+            (parser,
+             "ra",
+             "do reachability-analysis optimization during strategy determinisation (with --circuit only; see sdf-tlsf)",
+             {'a', "ra"});
+
+    EngineFlags engine_flags(parser);
+
+    TuningFlags tuning_flags(parser);
+
+    args::ValueFlag<uint> deadline_arg
+            (parser,
+             "deadline",
+             "per spec: do not try new k after this many seconds (0 means no deadline). "
+             "Default: 0.",
+             {"deadline"},
+             0);
+
+    args::ValueFlag<uint> timeout_arg
+            (parser,
+             "timeout",
+             "per spec: kill the worker after this many seconds (0 means no timeout). "
+             "Default: 0.",
+             {"timeout"},
+             0);
+
+    args::ValueFlag<string> listen_arg
+            (parser,
+             "address",
+             "coordinator mode: listen on this address (host:port, :port, or unix:path) "
+             "and distribute the specs over the nodes that connect to it (see --connect); "
+             "prints a summary line at the end",
+             {"listen"});
+
+    args::ValueFlag<string> connect_arg
+            (parser,
+             "address",
+             "node mode: connect to the coordinator at this address (host:port or unix:path) "
+             "and solve the specs it sends using --jobs workers; the other options come from the coordinator",
+             {"connect"});
+
+    args::Flag verbose_flag
+            (parser,
+             "v",
+             "verbose mode: the log of the workers goes to stderr (default: no log)",
+             {'v', "verbose"});
+
+    args::HelpFlag help
+        (parser,
+         "help",
+         "Display this help menu",
+         {'h', "help"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+        engine_flags.validate();
+        if (tuning_flags.checkpoint || tuning_flags.resume)
+            throw args::ValidationError("--checkpoint and --resume are per spec, not for a batch");
+    }
+    catch (args::Help&)
+    {
+        cout << parser;
+        return 0;
+    }
+    catch (args::ParseError& e)
+    {
+        cerr << e.what() << endl;
+        cerr << parser;
+        return 1;
+    }
+    catch (args::ValidationError& e)
+    {
+        cerr << e.what() << endl;
+        cerr << parser;
+        return 1;
+    }
+
+    if (listen_arg && connect_arg)
+    {
+        cerr << "--listen and --connect are exclusive" << endl;
+        return 1;
+    }
+    if (!connect_arg && !specs_arg)
+    {
+        cerr << "no specs given" << endl;
+        cerr << parser;
+        return 1;
+    }
+
+    // setup logging: stdout is for the results
+    spdlog::set_default_logger(spdlog::stderr_color_st("stderr"));
+    spdlog::set_pattern("%H:%M:%S %v ");
+    spdlog::set_level(verbose_flag ? spdlog::level::info : spdlog::level::off);
+
+    if (connect_arg)
+        return sdf::run_node(connect_arg.Get(), nof_workers_arg.Get());
+
+    // parse args
+    BatchDescr batch_descr;
+    batch_descr.spec_files = collect_spec_files(specs_arg.Get());
+    batch_descr.nof_workers = nof_workers_arg.Get();
+    batch_descr.k_to_iterate = engine_flags.k_list.Get();
+    batch_descr.check_unreal = check_dual_flag.Get();
+    batch_descr.output_dir = output_dir_arg ? output_dir_arg.Get() : "";
+    batch_descr.extract_model = extract_flag.Get() || !batch_descr.output_dir.empty();
+    batch_descr.engine = engine_flags.engine.Get();
+    batch_descr.k_policy = engine_flags.k_policy.Get();
+    batch_descr.do_reach_optim = do_reach_optim_flag.Get();
+    batch_descr.tuning = tuning_flags.get_tuning();
+    batch_descr.deadline_sec = deadline_arg.Get();
+    batch_descr.timeout_sec = timeout_arg.Get();
+
+    spdlog::info("batch: {} specs, {} workers, k: {}",
+                 batch_descr.spec_files.size(), batch_descr.nof_workers, join(", ", batch_descr.k_to_iterate));
+
+    if (listen_arg)
+        return sdf::run_coordinator(batch_descr, listen_arg.Get());
+    return sdf::run_batch(batch_descr);
+}
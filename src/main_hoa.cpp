@@ -6,6 +6,7 @@
 
 #include "utils.hpp"
 #include "synthesizer.hpp"
+#include "cli_flags.hpp"
 
 
 using namespace std;
@@ -20,7 +21,7 @@ int main(int argc, const char *argv[])
 
     args::Positional<string> hoa_arg
         (parser, "hoa",
-         "File with HOA specification",
+         "File with HOA specification ('-' for stdin)",
          args::Options::Required);
 
     args::Flag check_real_only_flag
@@ -33,18 +34,20 @@ int main(int argc, const char *argv[])
             (parser,
              "ra",
              "do reachability-analysis optimization during strategy determinisation (expensive);"
-             "automatically disabled when the number of states in the safety automaton > " + to_string(R_OPTIM_BOUND),
+             "automatically skipped when predicted not to pay off or when it exceeds the time the solving took",
              {'a', "ra"});
 
-    args::ValueFlagList<uint> k_list_arg
+    EngineFlags engine_flags(parser);
+
+    TuningFlags tuning_flags(parser);
+
+    args::ValueFlag<uint> deadline_arg
             (parser,
-             "k",
-             "the maximum number of times the same bad state can be visited "
-             "(thus, it is reset between SCCs). "
-             "If you provide it several times (e.g. -k 1 -k 4 -k 8), then I will try all those values in that order. "
-             "Default: 4.",
-             {'k'},
-             {4});
+             "deadline",
+             "do not try new k after this many seconds (0 means no deadline). "
+             "Default: 0.",
+             {"deadline"},
+             0);
 
     args::ValueFlag<string> output_name
             (parser,
@@ -73,6 +76,7 @@ int main(int argc, const char *argv[])
     try
     {
         parser.ParseCLI(argc, argv);
+        engine_flags.validate();
     }
     catch (args::Help&)
     {
@@ -102,9 +106,13 @@ int main(int argc, const char *argv[])
     // parse args
     string hoa_file_name(hoa_arg.Get());
     string output_file_name(output_name ? output_name.Get() : "stdout");
-    vector<uint> k_list(k_list_arg.Get());
+    vector<uint> k_list(engine_flags.k_list.Get());
     bool check_real_only(check_real_only_flag.Get());
     bool do_reach_analysis(do_reach_optim_flag.Get());
+    SolverEngine engine(engine_flags.engine.Get());
+    KBoundPolicy k_policy(engine_flags.k_policy.Get());
+    uint deadline_sec(deadline_arg.Get());
+    SolverTuning tuning(tuning_flags.get_tuning());
 
     if (do_reach_analysis && check_real_only)
     {
@@ -116,6 +124,6 @@ int main(int argc, const char *argv[])
     spdlog::info("hoa_file: {}, k: {}, output_file: {}",
                  hoa_file_name, join(", ", k_list), output_file_name);
 
-    return sdf::run_hoa(SpecDescr(false, hoa_file_name, !check_real_only, do_reach_analysis, output_file_name), k_list);
+    return sdf::run_hoa(SpecDescr(false, hoa_file_name, !check_real_only, do_reach_analysis, output_file_name, engine, k_policy, deadline_sec, tuning), k_list);
 }
 
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+#include <args.hxx>
+
+#include "utils.hpp"
+#include "server.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+int main(int argc, const char *argv[])
+{
+    args::ArgumentParser parser("Synthesis server: solves the specifications (TLSF or extended HOA) sent over a Unix domain socket "
+                                "(see server.hpp for the protocol)");
+    parser.helpParams.width = 100;
+    parser.helpParams.helpindent = 26;
+
+    args::Positional<string> socket_arg
+        (parser, "socket",
+         "path of the Unix domain socket to listen on",
+         args::Options::Required);
+
+    args::ValueFlag<uint> nof_jobs_arg
+            (parser,
+             "jobs",
+             "the number of requests solved concurrently. "
+             "Default: the number of cores.",
+             {'j', "jobs"},
+             max(1u, thread::hardware_concurrency()));
+
+    args::ValueFlag<uint> timeout_arg
+            (parser,
+             "timeout",
+             "default per-request timeout in seconds (0 means no timeout; a request can set its own). "
+             "Default: 0.",
+             {"timeout"},
+             0);
+
+    args::ValueFlag<uint> memory_arg
+            (parser,
+             "memory",
+             "default per-request memory cap in MB (0 means no cap; a request can set its own). "
+             "Default: 0.",
+             {"memory"},
+             0);
+
+    args::ValueFlag<uint> cache_size_arg
+            (parser,
+             "cache",
+             "the number of LTL->UCW translations kept in memory. "
+             "Default: 256.",
+             {"cache"},
+             256);
+
+    args::Flag verbose_flag
+            (parser,
+             "v",
+             "verbose mode (default: only the server events are logged)",
+             {'v', "verbose"});
+
+    args::HelpFlag help
+        (parser,
+         "help",
+         "Display this help menu",
+         {'h', "help"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (args::Help&)
+    {
+        cout << parser;
+        return 0;
+    }
+    catch (args::ParseError& e)
+    {
+        cerr << e.what() << endl;
+        cerr << parser;
+        return 1;
+    }
+    catch (args::ValidationError& e)
+    {
+        cerr << e.what() << endl;
+        cerr << parser;
+        return 1;
+    }
+
+    // setup logging
+    spdlog::set_pattern("%H:%M:%S %v ");
+    spdlog::set_level(verbose_flag ? spdlog::level::debug : spdlog::level::info);
+
+    ServerDescr server_descr;
+    server_descr.socket_path = socket_arg.Get();
+    server_descr.max_jobs = nof_jobs_arg.Get();
+    server_descr.timeout_sec = timeout_arg.Get();
+    server_descr.memory_mb = memory_arg.Get();
+    server_descr.cache_size = cache_size_arg.Get();
+
+    return sdf::run_server(server_descr);
+}
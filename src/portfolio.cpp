@@ -0,0 +1,248 @@
+#include "portfolio.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <fcntl.h>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+extern "C"
+{
+    #include <aiger.h>
+}
+
+#include "syntcomp_constants.hpp"
+#include "utils.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+using Clock = chrono::steady_clock;
+
+
+vector<PortfolioConfig> sdf::get_portfolio_configs(const SpecDescr& spec_descr)
+{
+    auto base = PortfolioConfig{"base", spec_descr.do_reach_optim, spec_descr.tuning};
+    vector<PortfolioConfig> configs = {base};
+
+    auto add = [&](const string& name, const function<void(PortfolioConfig&)>& change)
+    {
+        auto config = base;
+        config.name = name;
+        change(config);
+        configs.push_back(config);
+    };
+
+    auto other_levels = base.tuning.translation_level == TranslationLevel::medium
+                        ? vector<TranslationLevel>{TranslationLevel::high, TranslationLevel::low}
+                        : vector<TranslationLevel>{TranslationLevel::medium};
+    auto level_name = [](TranslationLevel level)
+    {
+        return level == TranslationLevel::low ? "low" : level == TranslationLevel::high ? "high" : "medium";
+    };
+
+    // the order: first the knobs that were seen to matter most
+    if (spec_descr.extract_model)
+        add(base.tuning.reorder_in_extraction ? "no-reorder" : "reorder",
+            [](PortfolioConfig& c) { c.tuning.reorder_in_extraction = !c.tuning.reorder_in_extraction; });
+    add(level_name(other_levels[0]),
+        [&](PortfolioConfig& c) { c.tuning.translation_level = other_levels[0]; });
+    if (spec_descr.extract_model)
+    {
+        add(base.do_reach_optim ? "no-ra" : "ra",
+            [](PortfolioConfig& c) { c.do_reach_optim = !c.do_reach_optim; });
+        add(base.tuning.extract_method == ExtractMethod::squeeze ? "abstraction" : "squeeze",
+            [](PortfolioConfig& c)
+            {
+                c.tuning.extract_method = c.tuning.extract_method == ExtractMethod::squeeze ? ExtractMethod::abstraction
+                                                                                            : ExtractMethod::squeeze;
+            });
+    }
+    for (uint i = 1; i < other_levels.size(); ++i)
+        add(level_name(other_levels[i]),
+            [&](PortfolioConfig& c) { c.tuning.translation_level = other_levels[i]; });
+
+    return configs;
+}
+
+
+/** (runs in the child process) the verdict is the exit code, the model goes into `model_file` */
+[[noreturn]] static void run_config(const SpecDescr& spec_descr,
+                                    const vector<uint>& k_to_iterate,
+                                    const PortfolioConfig& config,
+                                    const string& model_file,
+                                    uint memory_mb)
+{
+    rlimit limit{(rlim_t) memory_mb << 20, (rlim_t) memory_mb << 20};
+    setrlimit(RLIMIT_AS, &limit);
+
+    // stdout is for the verdict of the portfolio, so the log goes to stderr and the verdict of the child nowhere
+    auto level = spdlog::default_logger()->level();
+    spdlog::set_default_logger(spdlog::stderr_color_st(config.name));
+    spdlog::set_pattern("%H:%M:%S [" + config.name + "] %v ");
+    spdlog::set_level(level);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+
+    auto tuning = config.tuning;
+    if (!tuning.checkpoint_file.empty())  // (a checkpoint per configuration)
+        tuning.checkpoint_file += "." + config.name;
+    if (tuning.memory_mb == 0)  // (the BDD library degrades gracefully before the address-space limit kills the process)
+        tuning.memory_mb = memory_mb * 3 / 4;
+
+    try
+    {
+        _exit(run_tlsf(SpecDescr(spec_descr.check_unreal, spec_descr.file_name, spec_descr.extract_model,
+                                 config.do_reach_optim, model_file,
+                                 spec_descr.engine, spec_descr.k_policy, spec_descr.deadline_sec, tuning),
+                       k_to_iterate));
+    }
+    catch (const bad_alloc&)
+    {
+        spdlog::warn("out of memory (the limit is {} MB)", memory_mb);
+    }
+    catch (const exception& e)
+    {
+        spdlog::error("{}", e.what());
+    }
+    _exit(1);
+}
+
+
+static uint get_default_memory_mb(uint nof_configs)
+{
+    auto physical_mb = ((ulong) sysconf(_SC_PHYS_PAGES) * (ulong) sysconf(_SC_PAGE_SIZE)) >> 20;
+    return max(1ul, physical_mb / nof_configs);
+}
+
+
+int sdf::run_portfolio(const SpecDescr& spec_descr,
+                       const vector<uint>& k_to_iterate,
+                       const PortfolioDescr& portfolio_descr)
+{
+    auto configs = get_portfolio_configs(spec_descr);
+    configs.resize(min(configs.size(), (size_t) max(1u, portfolio_descr.nof_configs)));
+    auto memory_mb = portfolio_descr.memory_mb > 0 ? portfolio_descr.memory_mb : get_default_memory_mb(configs.size());
+    spdlog::info("portfolio: {} with {} MB each",
+                 join(", ", configs, [](const PortfolioConfig& c) { return c.name; }), memory_mb);
+
+    auto tmp_folder = create_tmp_folder();
+    auto model_file = [&](uint i) { return tmp_folder + "/" + configs[i].name + ".aag"; };
+
+    map<pid_t, uint> config_by_pid;
+    for (uint i = 0; i < configs.size(); ++i)
+    {
+        cout.flush();
+        pid_t pid = fork();
+        MASSERT(pid >= 0, "could not fork");
+        if (pid == 0)
+            run_config(spec_descr, k_to_iterate, configs[i], model_file(i), memory_mb);
+        config_by_pid[pid] = i;
+    }
+
+    // wait for the verdicts (and for the smaller models during the grace period)
+    optional<uint> winner;
+    int winner_rc = SYNTCOMP_RC_UNKNOWN;
+    uint winner_size = 0;
+    optional<Clock::time_point> first_model_time;
+    while (!config_by_pid.empty())
+    {
+        if (first_model_time.has_value() &&
+            chrono::duration<double>(Clock::now() - *first_model_time).count() >= portfolio_descr.grace_sec)
+            break;
+
+        // (only our configurations: the caller may have other children)
+        int status = 0;
+        pid_t pid = 0;
+        for (const auto& [config_pid, _]: config_by_pid)
+        {
+            auto rc = waitpid(config_pid, &status, WNOHANG);
+            MASSERT(rc >= 0 || errno == EINTR, "waitpid failed");
+            if (rc == config_pid)
+            {
+                pid = config_pid;
+                break;
+            }
+        }
+        if (pid == 0)
+        {
+            usleep(10000);
+            continue;
+        }
+
+        auto i = config_by_pid.at(pid);
+        config_by_pid.erase(pid);
+        auto rc = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        if (rc != SYNTCOMP_RC_REAL && rc != SYNTCOMP_RC_UNREAL)
+        {
+            spdlog::info("portfolio: {} gave no verdict ({})", configs[i].name,
+                         WIFSIGNALED(status) ? "killed by signal " + to_string(WTERMSIG(status))
+                                             : rc == SYNTCOMP_RC_UNKNOWN ? string("unknown") : "exit code " + to_string(rc));
+            continue;
+        }
+
+        if (!spec_descr.extract_model)
+        {
+            spdlog::info("portfolio: {} decided first", configs[i].name);
+            winner = i;
+            winner_rc = rc;
+            break;
+        }
+
+        aiger* model = aiger_init();
+        auto error = aiger_open_and_read_from_file(model, model_file(i).c_str());
+        MASSERT(error == nullptr, "could not read the model of " << configs[i].name << ": " << error);
+        auto size = model->num_ands + model->num_latches;
+        aiger_reset(model);
+        spdlog::info("portfolio: {} found a model of size {}", configs[i].name, size);
+
+        if (!winner.has_value() || size < winner_size)
+        {
+            winner = i;
+            winner_rc = rc;
+            winner_size = size;
+        }
+        if (!first_model_time.has_value())
+            first_model_time = Clock::now();
+    }
+
+    for (const auto& [pid, i]: config_by_pid)
+        kill(pid, SIGKILL);
+    for (const auto& [pid, i]: config_by_pid)
+        waitpid(pid, nullptr, 0);
+
+    if (!winner.has_value())
+    {
+        filesystem::remove_all(tmp_folder);
+        cout << SYNTCOMP_STR_UNKNOWN << endl;
+        return SYNTCOMP_RC_UNKNOWN;
+    }
+
+    spdlog::info("portfolio: the winner is {}", configs[*winner].name);
+    cout << (winner_rc == SYNTCOMP_RC_UNREAL ? SYNTCOMP_STR_UNREAL : SYNTCOMP_STR_REAL) << endl;
+
+    if (spec_descr.extract_model && !spec_descr.output_file_name.empty())
+    {
+        spdlog::info("writing a model to {}", spec_descr.output_file_name);
+        aiger* model = aiger_init();
+        MASSERT(aiger_open_and_read_from_file(model, model_file(*winner).c_str()) == nullptr, "could not read the model");
+        int res = (spec_descr.output_file_name == "stdout") ?
+                  aiger_write_to_file(model, aiger_ascii_mode, stdout):
+                  aiger_open_and_write_to_file(model, spec_descr.output_file_name.c_str());
+        MASSERT(res, "Could not write the model to file");
+        aiger_reset(model);
+    }
+
+    filesystem::remove_all(tmp_folder);
+    return winner_rc;
+}
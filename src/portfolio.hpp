@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "synthesizer.hpp"
+
+
+namespace sdf
+{
+
+struct PortfolioConfig
+{
+    std::string name;
+    bool do_reach_optim;
+    SolverTuning tuning;
+};
+
+struct PortfolioDescr
+{
+    uint nof_configs;    // run the first configurations of get_portfolio_configs (at least one)
+    uint memory_mb = 0;  // the address-space limit of every configuration (0: an equal share of the physical memory)
+    uint grace_sec = 0;  // after the first model, wait this long for the smaller models of the other configurations
+};
+
+/**
+ * @return the configurations in the order of preference:
+ *         the one of spec_descr first, then the ones that differ from it in one knob.
+ *         (The knobs that affect the model extraction only are varied only when the model is extracted.)
+ */
+std::vector<PortfolioConfig> get_portfolio_configs(const SpecDescr& spec_descr);
+
+/**
+ * Run several configurations on the TLSF spec (as run_tlsf does), each in its own process with its own memory limit.
+ * The first definitive verdict wins; when the model is extracted, the smallest circuit
+ * among those ready within the grace period wins. The other processes are killed.
+ * (Processes, not threads: spot's BuDDy is a global state, and a process that runs out of memory does not take the others down.)
+ * The verdict and the model are printed/written as run_tlsf does.
+ * @return code according to SYNTCOMP (as run_tlsf)
+ */
+int run_portfolio(const SpecDescr& spec_descr,
+                  const std::vector<uint>& k_to_iterate,
+                  const PortfolioDescr& portfolio_descr);
+
+} //namespace sdf
@@ -0,0 +1,290 @@
+#include "reachability.hpp"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include "utils.hpp"
+
+
+using namespace std;
+
+
+#define hmap unordered_map
+
+
+sdf::Reachability::Reachability(Cudd& cudd_,
+                                const hmap<uint, BDD>& next_by_latch,
+                                const vector<BDD>& signals_,
+                                ulong range_budget_) :
+    cudd(cudd_),
+    signals(signals_),
+    max_range_budget(range_budget_),
+    use_range(range_budget_ > 0)
+{
+    vector<uint> latches;
+    for (const auto& [cuddIdx, func]: next_by_latch)
+        latches.push_back(cuddIdx);
+    sort(latches.begin(), latches.end());
+    for (auto cuddIdx: latches)
+    {
+        latch_vars.push_back(cudd.ReadVars((int)cuddIdx));
+        next_funcs.push_back(next_by_latch.at(cuddIdx));
+    }
+}
+
+
+double sdf::Reachability::estimate_image_cost(const BDD& constraint) const
+{
+    return (double) constraint.nodeCount() * cudd.nodeCount(next_funcs);
+}
+
+
+BDD sdf::Reachability::compute(const BDD& init, const BDD& constraint)
+{
+    BDD reach = init;
+    BDD frontier = init;
+    for (uint i = 0; ; ++i)
+    {
+        spdlog::debug("reachability: iteration {}: node count: {}", i, cudd.ReadNodeCount());
+
+        BDD new_states = image(frontier & constraint) & ~reach;
+        if (new_states.IsZero())
+        {
+            spdlog::info("reachability: the fixpoint after {} iterations (the image via {})",
+                         i, use_range ? "range" : "partitioned relation");
+            return reach;
+        }
+        reach |= new_states;
+        frontier = new_states.Squeeze(reach);  // (any set between the new states and the reachable ones will do)
+    }
+}
+
+
+BDD sdf::Reachability::image(const BDD& domain)
+{
+    if (domain.IsZero())
+        return cudd.bddZero();
+
+    if (use_range)
+    {
+        if (auto img = image_via_range(domain))
+            return *img;
+        spdlog::info("reachability: the range computation exceeded its budget, switching to the partitioned relation");
+        use_range = false;
+    }
+    return image_via_clusters(domain);
+}
+
+
+optional<BDD> sdf::Reachability::image_via_range(const BDD& domain)
+{
+    // the image of the (non-empty) domain is the range of the functions constrained by it
+    vector<pair<BDD, BDD>> funcs;
+    for (size_t j = 0; j < latch_vars.size(); ++j)
+        funcs.emplace_back(latch_vars[j], next_funcs[j].Constrain(domain));
+
+    range_budget = max_range_budget;
+    return range(funcs);
+}
+
+
+/** @return the groups of the functions such that the functions of different groups have disjoint supports */
+static vector<vector<pair<BDD, BDD>>> group_by_support(const vector<pair<BDD, BDD>>& funcs)
+{
+    // union-find over the functions
+    vector<size_t> parent(funcs.size());
+    iota(parent.begin(), parent.end(), 0);
+    auto find_root = [&](size_t j)
+    {
+        while (parent[j] != j)
+            j = parent[j] = parent[parent[j]];
+        return j;
+    };
+
+    hmap<uint, size_t> func_by_var;  // (a function whose support has the variable)
+    for (size_t j = 0; j < funcs.size(); ++j)
+        for (auto var: funcs[j].second.SupportIndices())
+        {
+            auto it = func_by_var.find(var);
+            if (it == func_by_var.end())
+                func_by_var.emplace(var, j);
+            else
+                parent[find_root(j)] = find_root(it->second);
+        }
+
+    map<size_t, vector<pair<BDD, BDD>>> group_by_root;
+    for (size_t j = 0; j < funcs.size(); ++j)
+        group_by_root[find_root(j)].push_back(funcs[j]);
+
+    vector<vector<pair<BDD, BDD>>> groups;
+    for (auto& [root, group]: group_by_root)
+        groups.push_back(move(group));
+    return groups;
+}
+
+
+optional<BDD> sdf::Reachability::range(const vector<pair<BDD, BDD>>& funcs)
+{
+    /* The range is built over the latch variables themselves:
+     * the result is composed of the latch literals only, the functions are used as the constraints only.
+     *   range(f_1, ..., f_n) = x_1 & range(f_2↓f_1, ..., f_n↓f_1) | ~x_1 & range(f_2↓~f_1, ..., f_n↓~f_1)
+     * (for a non-constant f_1, where ↓ is the generalized cofactor)  */
+
+    if (range_budget == 0)
+        return nullopt;
+    --range_budget;
+
+    BDD result = cudd.bddOne();
+    vector<pair<BDD, BDD>> non_constant;
+    for (const auto& [var, func]: funcs)
+        if (func.IsOne())
+            result &= var;
+        else if (func.IsZero())
+            result &= ~var;
+        else
+            non_constant.emplace_back(var, func);
+    if (non_constant.empty())
+        return result;
+
+    auto groups = group_by_support(non_constant);
+    if (groups.size() > 1)
+    {
+        for (const auto& group: groups)
+        {
+            auto group_range = range(group);
+            if (!group_range)
+                return nullopt;
+            result &= *group_range;
+        }
+        return result;
+    }
+
+    const auto& [var, func] = non_constant.front();
+    vector<pair<BDD, BDD>> when_true, when_false;
+    for (size_t j = 1; j < non_constant.size(); ++j)
+    {
+        when_true.emplace_back(non_constant[j].first, non_constant[j].second.Constrain(func));
+        when_false.emplace_back(non_constant[j].first, non_constant[j].second.Constrain(~func));
+    }
+    auto range_true = range(when_true);
+    if (!range_true)
+        return nullopt;
+    auto range_false = range(when_false);
+    if (!range_false)
+        return nullopt;
+    return result & ((var & *range_true) | (~var & *range_false));
+}
+
+
+BDD sdf::Reachability::image_via_clusters(const BDD& domain)
+{
+    if (!are_clusters_built)
+        build_clusters();
+
+    BDD img = domain.ExistAbstract(cube_before);
+    for (size_t c = 0; c < clusters.size(); ++c)
+        img = img.AndAbstract(clusters[c], cube_after[c]);
+    return img.SwapVariables(primed_vars, latch_vars);  // (unpriming)
+}
+
+
+void sdf::Reachability::build_clusters()
+{
+    spdlog::info("reachability: building the partitioned relation for {} latches...", latch_vars.size());
+    are_clusters_built = true;
+
+    // the partitions x_j' <-> f_j(x,i,o), with x_j' right below x_j in the variable order
+    vector<BDD> partitions;
+    vector<vector<uint>> supports;
+    for (size_t j = 0; j < latch_vars.size(); ++j)
+    {
+        primed_vars.push_back(cudd.bddNewVarAtLevel(cudd.ReadPerm((int)latch_vars[j].NodeReadIndex()) + 1));
+        cudd.pushVariableName(string("s'") + to_string(j));
+        partitions.push_back(primed_vars.back().Xnor(next_funcs[j]));
+        supports.push_back(next_funcs[j].SupportIndices());
+    }
+
+    // order: greedily, the partition after which the most variables can be quantified
+    // (those that occur in no later partition); on ties, the one with the smaller support
+    vector<size_t> order;
+    if (partitions.size() <= REACH_ORDERING_BOUND)
+    {
+        hmap<uint, uint> nof_partitions_by_var;  // (among the partitions not yet placed)
+        for (const auto& support: supports)
+            for (auto var: support)
+                ++nof_partitions_by_var[var];
+
+        vector<bool> is_placed(partitions.size(), false);
+        for (size_t step = 0; step < partitions.size(); ++step)
+        {
+            optional<size_t> best;
+            pair<long, long> best_score;
+            for (size_t j = 0; j < partitions.size(); ++j)
+            {
+                if (is_placed[j])
+                    continue;
+                auto nof_freed = count_if(supports[j].begin(), supports[j].end(),
+                                          [&](uint var) { return nof_partitions_by_var[var] == 1; });
+                auto score = make_pair((long) nof_freed, -(long) supports[j].size());
+                if (!best || score > best_score)
+                {
+                    best = j;
+                    best_score = score;
+                }
+            }
+            is_placed[*best] = true;
+            order.push_back(*best);
+            for (auto var: supports[*best])
+                --nof_partitions_by_var[var];
+        }
+    }
+    else
+    {
+        order.resize(partitions.size());
+        iota(order.begin(), order.end(), 0);
+    }
+
+    // clusters
+    vector<vector<uint>> cluster_supports;
+    for (auto j: order)
+    {
+        if (!clusters.empty())
+        {
+            BDD conjoined = clusters.back() & partitions[j];
+            if (conjoined.nodeCount() <= REACH_CLUSTER_SIZE)
+            {
+                clusters.back() = conjoined;
+                cluster_supports.back().insert(cluster_supports.back().end(), supports[j].begin(), supports[j].end());
+                continue;
+            }
+        }
+        clusters.push_back(partitions[j]);
+        cluster_supports.push_back(supports[j]);
+    }
+
+    // the quantification schedule: every variable goes right after its last cluster
+    hmap<uint, size_t> last_cluster_by_var;
+    for (size_t c = 0; c < clusters.size(); ++c)
+        for (auto var: cluster_supports[c])
+            last_cluster_by_var[var] = c;
+
+    vector<BDD> vars_before;
+    vector<vector<BDD>> vars_after(clusters.size());
+    for (const auto& var: sdf::a_union_b(latch_vars, signals))
+    {
+        auto it = last_cluster_by_var.find(var.NodeReadIndex());
+        if (it == last_cluster_by_var.end())
+            vars_before.push_back(var);
+        else
+            vars_after[it->second].push_back(var);
+    }
+    cube_before = cudd.computeCube(vars_before);
+    for (const auto& vars: vars_after)
+        cube_after.push_back(cudd.computeCube(vars));
+
+    spdlog::info("reachability: {} clusters of {} nodes in total", clusters.size(), cudd.nodeCount(clusters));
+}
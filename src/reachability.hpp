@@ -0,0 +1,79 @@
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <mtr.h>  // mtr before cudd
+#include <cudd.h>
+#include <cuddObj.hh>
+
+
+namespace sdf
+{
+
+const ulong REACH_RANGE_BUDGET = 100000;  // the recursive calls of one range computation before switching to the partitioned relation
+const int REACH_CLUSTER_SIZE = 5000;      // (BDD nodes) the partitions are conjoined into clusters up to this size
+const uint REACH_ORDERING_BOUND = 2000;   // the partitions are ordered for early quantification only up to this number of latches
+
+/**
+ * Forward reachability of a circuit whose latches are given by their next-state functions x_j' = f_j(x,i,o),
+ * restricted to the transitions (x,i,o) that satisfy a constraint (e.g., the strategy).
+ *
+ * While the encoding allows it, the image is computed without primed variables:
+ * as the range of the next-state functions constrained (generalized cofactor) by the domain,
+ * splitting on one function at a time, the functions with disjoint supports being ranged independently.
+ * This is cheap when every latch depends on a few others (as the latches of the automaton states do), but can blow up:
+ * once a range computation exceeds REACH_RANGE_BUDGET, the engine switches for good to the partitioned relation
+ * x_j' <-> f_j (the primed variable next to the unprimed one), with the partitions ordered for early quantification,
+ * conjoined into clusters of up to REACH_CLUSTER_SIZE nodes, and every variable quantified right after its last cluster.
+ * The primed variables stay in the manager (CUDD cannot remove variables), with the indices after those of the game:
+ * the callers that count the variables count those before them (see GameSolver::nof_game_vars).
+ */
+class Reachability
+{
+public:
+    /**
+     * @param next_by_latch: cudd index of a latch -> its next-state function
+     * @param signals: the variables of the inputs and the outputs
+     * @param range_budget_: the budget of one range computation (0 means the partitioned relation from the start)
+     */
+    Reachability(Cudd& cudd_,
+                 const std::unordered_map<uint, BDD>& next_by_latch,
+                 const std::vector<BDD>& signals_,
+                 ulong range_budget_ = REACH_RANGE_BUDGET);
+
+    /** @return a rough number of node visits of one image step (the product of the operand sizes, as for and-exists) */
+    double estimate_image_cost(const BDD& constraint) const;
+
+    /** @return the states reachable from `init` via the transitions that satisfy `constraint` */
+    BDD compute(const BDD& init, const BDD& constraint);
+
+private:
+    Cudd& cudd;
+    std::vector<BDD> latch_vars;  // (ordered by the cudd index)
+    std::vector<BDD> next_funcs;  // next_funcs[j] is the next-state function of latch_vars[j]
+    const std::vector<BDD> signals;
+
+    const ulong max_range_budget;
+    bool use_range;
+    ulong range_budget = 0;       // (the recursive calls left in the current range computation)
+
+    // the partitioned relation (built when first needed)
+    bool are_clusters_built = false;
+    std::vector<BDD> primed_vars;
+    std::vector<BDD> clusters;
+    BDD cube_before;              // the variables that occur in no cluster
+    std::vector<BDD> cube_after;  // cube_after[c]: the variables whose last occurrence is in clusters[c]
+
+    BDD image(const BDD& domain);
+
+    std::optional<BDD> image_via_range(const BDD& domain);
+    std::optional<BDD> range(const std::vector<std::pair<BDD, BDD>>& funcs);  // (latch variable, function)
+
+    BDD image_via_clusters(const BDD& domain);
+    void build_clusters();
+};
+
+} //namespace sdf
@@ -0,0 +1,199 @@
+#include "reordering.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#include <spdlog/spdlog.h>
+
+#include "my_assert.hpp"
+
+
+using namespace std;
+
+
+#define hmap unordered_map
+
+
+// the CUDD hooks get no user data, hence the policy of every manager
+// (the managers of concurrent solvers, e.g. of the server, register and look up in parallel, hence the mutex)
+static hmap<DdManager*, sdf::AdaptiveReordering*> reordering_by_manager;
+static mutex reordering_by_manager_mutex;
+
+
+static sdf::AdaptiveReordering* get_reordering(DdManager* dd)
+{
+    lock_guard<mutex> lock(reordering_by_manager_mutex);
+    return reordering_by_manager.at(dd);
+}
+
+
+static const char* get_method_name(Cudd_ReorderingType method)
+{
+    switch (method)
+    {
+        case CUDD_REORDER_SIFT: return "sift";
+        case CUDD_REORDER_GROUP_SIFT: return "group sift";
+        case CUDD_REORDER_WINDOW3: return "window3";
+        default: return "other";
+    }
+}
+
+
+sdf::AdaptiveReordering::AdaptiveReordering(Cudd& cudd_) :
+    cudd(cudd_)
+{
+    {
+        lock_guard<mutex> lock(reordering_by_manager_mutex);
+        MASSERT(!reordering_by_manager.count(cudd.getManager()), "the manager already has a reordering policy");
+        reordering_by_manager[cudd.getManager()] = this;
+    }
+    cudd.AddHook(on_pre_reordering, CUDD_PRE_REORDERING_HOOK);
+    cudd.AddHook(on_post_reordering, CUDD_POST_REORDERING_HOOK);
+}
+
+
+sdf::AdaptiveReordering::~AdaptiveReordering()
+{
+    cudd.RemoveHook(on_pre_reordering, CUDD_PRE_REORDERING_HOOK);
+    cudd.RemoveHook(on_post_reordering, CUDD_POST_REORDERING_HOOK);
+    lock_guard<mutex> lock(reordering_by_manager_mutex);
+    reordering_by_manager.erase(cudd.getManager());
+}
+
+
+void sdf::AdaptiveReordering::start_phase(const string& name)
+{
+    phase = name;
+    stats.clear();
+    for (auto method: {CUDD_REORDER_SIFT, CUDD_REORDER_GROUP_SIFT, CUDD_REORDER_WINDOW3})
+        stats.push_back(MethodStats{method});
+    current = 0;
+    nof_fruitless = 0;
+    is_enabled = true;
+    cudd.AutodynEnable(stats[current].method);
+}
+
+
+Cudd_ReorderingType sdf::AdaptiveReordering::get_final_method() const
+{
+    auto best = CUDD_REORDER_SIFT;
+    double best_rate = 0;
+    for (const auto& s: stats)
+        if (s.nof_passes > 0 && s.gain / max(s.sec, 0.001) > best_rate)
+        {
+            best = s.method;
+            best_rate = s.gain / max(s.sec, 0.001);
+        }
+    return best == CUDD_REORDER_GROUP_SIFT ? CUDD_REORDER_GROUP_SIFT_CONV :
+           best == CUDD_REORDER_WINDOW3 ? CUDD_REORDER_WINDOW3_CONV :
+                                          CUDD_REORDER_SIFT_CONVERGE;
+}
+
+
+int sdf::AdaptiveReordering::on_pre_reordering(DdManager* dd, const char*, void* data)
+{
+    auto reordering = get_reordering(dd);
+    reordering->nodes_before = Cudd_ReadNodeCount(dd);
+    reordering->start_time = chrono::steady_clock::now();
+
+    // time-box the passes of the dynamic reordering (not the explicit ReduceHeap, e.g. the final one, with other methods),
+    // within the time limit already set, if any (as with_time_limit does)
+    reordering->is_time_boxed = reordering->is_enabled &&
+                                (Cudd_ReorderingType) (intptr_t) data == reordering->stats[reordering->current].method;
+    if (reordering->is_time_boxed)
+    {
+        const auto& cudd = reordering->cudd;
+        auto limit_ms = (unsigned long) (REORDER_PASS_SEC * 1000);
+        reordering->outer_time_limit.reset();
+        if (cudd.TimeLimited())
+        {
+            reordering->outer_time_limit = {cudd.ReadStartTime(), cudd.ReadTimeLimit()};
+            auto elapsed_ms = cudd.ReadElapsedTime();
+            auto outer_ms = reordering->outer_time_limit->second;
+            limit_ms = min(limit_ms, outer_ms > elapsed_ms ? outer_ms - elapsed_ms : 0ul);
+        }
+        cudd.ResetStartTime();
+        cudd.SetTimeLimit(limit_ms);
+    }
+    return 1;
+}
+
+
+int sdf::AdaptiveReordering::on_post_reordering(DdManager* dd, const char*, void*)
+{
+    auto reordering = get_reordering(dd);
+    auto sec = chrono::duration<double>(chrono::steady_clock::now() - reordering->start_time).count();
+
+    bool is_cut = false;
+    if (reordering->is_time_boxed)
+    {
+        const auto& cudd = reordering->cudd;
+        is_cut = cudd.ReadElapsedTime() >= cudd.ReadTimeLimit();
+        cudd.UnsetTimeLimit();
+        if (reordering->outer_time_limit)
+        {
+            cudd.SetStartTime(reordering->outer_time_limit->first);
+            cudd.SetTimeLimit(reordering->outer_time_limit->second);
+        }
+    }
+
+    reordering->on_pass(Cudd_ReadNodeCount(dd), sec, is_cut);
+
+    // (a sifting cut by the time limit disables the dynamic reordering of CUDD)
+    if (is_cut && reordering->is_enabled)
+        reordering->cudd.AutodynEnable(reordering->stats[reordering->current].method);
+    return 1;
+}
+
+
+void sdf::AdaptiveReordering::on_pass(long nodes_after, double sec, bool is_cut)
+{
+    if (!is_enabled || stats.empty())
+        return;  // (an explicit ReduceHeap after the dynamic reordering was disabled)
+
+    auto gain = nodes_before > 0 ? 1 - (double) nodes_after / (double) nodes_before : 0.;
+    auto& s = stats[current];
+    ++s.nof_passes;
+    s.gain += max(0., gain);
+    s.sec += sec;
+    spdlog::debug("reordering ({}): {}: {} -> {} nodes in {:.2f} sec",
+                  phase, get_method_name(s.method), nodes_before, nodes_after, sec);
+
+    if (is_cut || sec > REORDER_PASS_SEC)
+    {
+        auto max_swap = max(1000, Cudd_ReadSiftMaxSwap(cudd.getManager()) / 2);
+        auto max_var = max(100, Cudd_ReadSiftMaxVar(cudd.getManager()) / 2);
+        cudd.SetSiftMaxSwap(max_swap);
+        cudd.SetSiftMaxVar(max_var);
+        spdlog::info("reordering ({}): a pass {} {:.0f} sec, at most {} swaps and {} sifted variables from now on",
+                     phase, is_cut ? "was cut after" : "took", sec, max_swap, max_var);
+    }
+
+    if (gain >= REORDER_MIN_GAIN)
+    {
+        nof_fruitless = 0;
+        return;
+    }
+
+    // the next pass only when the size doubles
+    cudd.SetNextReordering((unsigned) min(2 * nodes_after, (long) numeric_limits<unsigned>::max()));
+    if (++nof_fruitless < REORDER_MAX_FRUITLESS)
+        return;
+
+    nof_fruitless = 0;
+    if (current + 1 < stats.size())
+    {
+        ++current;
+        cudd.AutodynEnable(stats[current].method);
+        spdlog::info("reordering ({}): {} does not pay off, switching to {}",
+                     phase, get_method_name(s.method), get_method_name(stats[current].method));
+    }
+    else
+    {
+        is_enabled = false;
+        cudd.AutodynDisable();
+        spdlog::info("reordering ({}): no method pays off, disabling the dynamic reordering", phase);
+    }
+}
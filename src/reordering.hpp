@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mtr.h>  // mtr before cudd
+#include <cudd.h>
+#include <cuddObj.hh>
+
+
+namespace sdf
+{
+
+const double REORDER_MIN_GAIN = 0.05;   // a reordering pass pays off when it removes at least this fraction of the nodes
+const uint REORDER_MAX_FRUITLESS = 2;   // after this many passes in a row that do not pay off, the next method is tried
+const double REORDER_PASS_SEC = 10;     // a pass is cut after this long, and then halves the sifting bounds (the number of swaps and of variables)
+
+/**
+ * The dynamic reordering of ReorderPolicy::adaptive.
+ * Observes every reordering pass via the CUDD reordering hooks (the gain in nodes and the time), and:
+ * - moves on from a method (sift, group sift, window of 3) after REORDER_MAX_FRUITLESS passes that did not pay off,
+ *   and disables the dynamic reordering when none of the methods pays off any more;
+ * - time-boxes the passes: CUDD cuts a pass after REORDER_PASS_SEC (or when the time limit already set expires),
+ *   and such a pass halves the sifting bounds;
+ * - postpones the next pass (to twice the current size) after a fruitless one.
+ * The statistics are per phase (the fixpoint and the extraction behave differently): start_phase forgets them.
+ */
+class AdaptiveReordering
+{
+public:
+    explicit AdaptiveReordering(Cudd& cudd_);
+    ~AdaptiveReordering();
+
+    AdaptiveReordering(const AdaptiveReordering&) = delete;
+    AdaptiveReordering& operator=(const AdaptiveReordering&) = delete;
+
+    /** (re-)enable the dynamic reordering with the first method and forget the statistics */
+    void start_phase(const std::string& name);
+
+    /** @return false once no method pays off in the current phase (then the dynamic reordering is disabled) */
+    bool is_paying_off() const { return is_enabled; }
+
+    /** @return the converging variant of the method with the best gain per second in the current phase */
+    Cudd_ReorderingType get_final_method() const;
+
+private:
+    struct MethodStats
+    {
+        Cudd_ReorderingType method;
+        uint nof_passes = 0;
+        double gain = 0;  // (the removed nodes, as the fraction of the nodes before, summed over the passes)
+        double sec = 0;
+    };
+
+    Cudd& cudd;
+    std::string phase;
+    std::vector<MethodStats> stats;
+    size_t current = 0;
+    uint nof_fruitless = 0;  // (in a row, of the current method)
+    bool is_enabled = false;
+
+    long nodes_before = 0;
+    std::chrono::steady_clock::time_point start_time;
+    bool is_time_boxed = false;  // (the current pass)
+    std::optional<std::pair<unsigned long, unsigned long>> outer_time_limit;  // (start time, limit) set before the pass
+
+    static int on_pre_reordering(DdManager* dd, const char* str, void* data);
+    static int on_post_reordering(DdManager* dd, const char* str, void* data);
+
+    void on_pass(long nodes_after, double sec, bool is_cut);
+};
+
+} //namespace sdf
@@ -0,0 +1,507 @@
+#include "server.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <list>
+#include <optional>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#define BDD spotBDD
+    #include <spot/tl/print.hh>
+    #include <spot/twaalgos/hoa.hh>
+    #include <spot/parseaut/public.hh>
+#undef BDD
+
+extern "C"
+{
+    #include <aiger.h>
+}
+
+#include "synthesizer.hpp"
+#include "ltl_parser.hpp"
+#include "ehoa_parser.hpp"
+#include "syntcomp_constants.hpp"
+#include "utils.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+#define hmap unordered_map
+#define hset unordered_set
+
+
+using Clock = chrono::steady_clock;
+
+
+namespace
+{
+
+/** LTL formula (as printed by spot) -> UCW in the HOA format */
+class TranslationCache
+{
+public:
+    explicit TranslationCache(uint capacity_) : capacity(capacity_) { }
+
+    const string* find(const string& key) const
+    {
+        auto it = entry_by_key.find(key);
+        return it == entry_by_key.end() ? nullptr : &it->second->second;
+    }
+
+    void touch(const string& key)
+    {
+        auto it = entry_by_key.find(key);
+        if (it != entry_by_key.end())
+            entries.splice(entries.begin(), entries, it->second);
+    }
+
+    void put(const string& key, string hoa)
+    {
+        if (capacity == 0 || find(key) != nullptr)
+            return;
+        entries.emplace_front(key, move(hoa));
+        entry_by_key[key] = entries.begin();
+        if (entries.size() > capacity)
+        {
+            entry_by_key.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+private:
+    const uint capacity;
+    list<pair<string, string>> entries;  // most recently used first
+    hmap<string, list<pair<string, string>>::iterator> entry_by_key;
+};
+
+
+struct Request
+{
+    hmap<string, string> options;
+    string spec;
+
+    string get(const string& key, const string& default_value) const
+    {
+        auto it = options.find(key);
+        return it == options.end() ? default_value : it->second;
+    }
+
+    uint get_uint(const string& key, uint default_value) const
+    {
+        auto it = options.find(key);
+        return it == options.end() ? default_value : (uint) stoul(it->second);
+    }
+
+    bool get_bool(const string& key, bool default_value) const
+    {
+        auto value = lower(get(key, default_value ? "true" : "false"));
+        MASSERT(value == "true" || value == "false", "expected true or false for " << key << ", got: " << value);
+        return value == "true";
+    }
+
+    template<typename T>
+    T get_by_name(const string& key, const hmap<string, T>& by_name, const string& default_name) const
+    {
+        auto name = get(key, default_name);
+        MASSERT(by_name.count(name), "unknown " << key << ": " << name);
+        return by_name.at(name);
+    }
+};
+
+
+/** A request being solved in a forked process */
+struct Job
+{
+    pid_t pid;
+    int client_fd;
+    int channel_fd;   // messages from the process (see send_message)
+    string buffer;    // (incomplete messages)
+    bool is_done;     // has the process sent the response?
+};
+
+}
+
+
+static volatile sig_atomic_t is_stopping = 0;
+
+static void on_stop_signal(int) { is_stopping = 1; }
+
+
+static bool read_some(int fd, string& buffer)
+{
+    char chunk[1 << 16];
+    while (true)
+    {
+        auto n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buffer.append(chunk, n);
+        return true;
+    }
+}
+
+
+static void write_all(int fd, const string& data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;  // (the client is gone: nothing to do)
+        written += n;
+    }
+}
+
+
+static Request read_request(int fd)
+{
+    string buffer;
+    size_t header_end;
+    while ((header_end = buffer.find("\n\n")) == string::npos)
+        MASSERT(read_some(fd, buffer), "the request header is not terminated by an empty line");
+
+    Request request;
+    stringstream header(buffer.substr(0, header_end));
+    for (string line; getline(header, line); )
+    {
+        if (trim_spaces(line).empty())
+            continue;
+        auto colon = line.find(':');
+        MASSERT(colon != string::npos, "expected 'key: value', got: " << line);
+        request.options[lower(trim_spaces(line.substr(0, colon)))] = trim_spaces(line.substr(colon + 1));
+    }
+
+    request.spec = buffer.substr(header_end + 2);
+    if (request.options.count("length"))
+    {
+        auto length = (size_t) stoul(request.options.at("length"));
+        while (request.spec.size() < length)
+            MASSERT(read_some(fd, request.spec), "the spec is shorter than its length");
+        request.spec.resize(length);
+    }
+    else
+        while (read_some(fd, request.spec)) { }
+    return request;
+}
+
+
+static string format_response(const vector<pair<string, string>>& fields, const string& model = "")
+{
+    stringstream ss;
+    for (const auto& [key, value]: fields)
+        ss << key << ": " << substituteAll(value, "\n", " ") << "\n";
+    ss << "length: " << model.size() << "\n\n" << model;
+    return ss.str();
+}
+
+
+static int put_char(char c, void* state)
+{
+    ((string*) state)->push_back(c);
+    return c;
+}
+
+
+/**
+ * Messages from the request process to the server: `<tag> <payload length>\n<payload>`, where
+ * CACHE has the payload `<formula>\n<hoa>` (a new translation),
+ * HIT has the payload `<formula>` (a used translation),
+ * DONE has no payload and means the response was sent.
+ */
+static void send_message(int channel_fd, const string& tag, const string& payload = "")
+{
+    write_all(channel_fd, tag + " " + to_string(payload.size()) + "\n" + payload);
+}
+
+
+/** (runs in the request process) */
+static string solve_request(const Request& request, const TranslationCache& cache, int channel_fd, uint memory_mb)
+{
+    auto start = Clock::now();
+
+    auto format = request.get("format", "tlsf");
+    MASSERT(format == "tlsf" || format == "ehoa", "unknown format: " << format);
+    auto engine = request.get_by_name("engine", get_engine_by_name(), "symbolic");
+    auto k_policy = request.get_by_name("k-policy", get_k_policy_by_name(), "uniform");
+    bool check_unreal = request.get_bool("dual", false);
+    bool extract_model = request.get_bool("model", true);
+    bool do_reach_optim = extract_model && request.get_bool("ra", false);
+    MASSERT(format == "tlsf" || !check_unreal, "the unrealizability check is supported for TLSF only");
+
+    SolverTuning tuning;
+    tuning.translation_level = request.get_by_name("translation-level", get_translation_level_by_name(), "medium");
+    tuning.extract_method = request.get_by_name("extract", get_extract_method_by_name(), "abstraction");
+    tuning.extract_order = request.get_by_name("extract-order", get_extract_order_by_name(), "fixed");
+    tuning.reorder_policy = request.get_by_name("reorder", get_reorder_policy_by_name(), "sift");
+    tuning.anytime_sec = request.get_uint("anytime", 0);
+    tuning.prune_signals = request.get_bool("signal-pruning", true);
+    tuning.memory_mb = memory_mb * 3 / 4;  // (as in the portfolio: CUDD degrades gracefully before the address-space cap kills the process)
+
+    vector<uint> k_to_iterate;
+    for (const auto& k: split_by_space(request.get("k", "4")))
+        k_to_iterate.push_back(stoul(k));
+    MASSERT(!k_to_iterate.empty(), "no k given");
+
+    spot::twa_graph_ptr ucw;
+    hset<spot::formula> inputs, outputs;
+    bool is_moore;
+    bool is_cached = false;
+    if (format == "tlsf")
+    {
+        spot::formula formula;
+        tie(formula, inputs, outputs, is_moore) = parse_tlsf_string(request.spec);
+        if (check_unreal)
+        {   // (as in run_tlsf)
+            formula = spot::formula::Not(formula);
+            swap(inputs, outputs);
+            is_moore = !is_moore;
+        }
+
+        auto key = spot::str_psl(formula);
+        if (auto cached_hoa = cache.find(key))
+        {
+            auto pa = spot::automaton_stream_parser(cached_hoa->c_str(), "cache").parse(spot::make_bdd_dict());
+            MASSERT(!pa->aborted, "could not parse the cached automaton");
+            if (stringstream ss; pa->format_errors(ss))
+                MASSERT(0, "could not parse the cached automaton: " << ss.str());
+            ucw = pa->aut;
+            is_cached = true;
+            send_message(channel_fd, "HIT", key);
+        }
+        else
+        {
+            ucw = translate_to_ucw(formula, tuning.translation_level);
+            stringstream hoa;
+            spot::print_hoa(hoa, ucw);
+            send_message(channel_fd, "CACHE", key + "\n" + hoa.str());
+        }
+    }
+    else
+        tie(ucw, inputs, outputs, is_moore) = read_ehoa_text(request.spec, "request");
+
+    aiger* model = nullptr;
+    SynthStats stats;
+    bool is_real = synthesize_atm(SpecDescr2(ucw, inputs, outputs, is_moore, extract_model, do_reach_optim,
+                                             engine, k_policy, request.get_uint("deadline", 0), nullptr, tuning),
+                                  k_to_iterate, model, &stats);
+
+    string model_text;
+    if (model != nullptr)
+    {
+        MASSERT(aiger_write_generic(model, aiger_ascii_mode, &model_text, put_char), "could not write the model");
+        aiger_reset(model);
+    }
+
+    string status = !is_real ? SYNTCOMP_STR_UNKNOWN : check_unreal ? SYNTCOMP_STR_UNREAL : SYNTCOMP_STR_REAL;
+    return format_response({{"status", status},
+                            {"k", to_string(stats.k)},
+                            {"time_sec", to_string(chrono::duration<double>(Clock::now() - start).count())},
+                            {"cached", is_cached ? "true" : "false"}},
+                           model_text);
+}
+
+
+/** (runs in the request process) */
+[[noreturn]] static void serve_request(const ServerDescr& server_descr, const TranslationCache& cache,
+                                       int client_fd, int channel_fd)
+{
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    string response;
+    try
+    {
+        // (a client that never sends its request must not hold the job slot forever)
+        alarm(server_descr.timeout_sec > 0 ? min(server_descr.timeout_sec, REQUEST_READ_SEC) : REQUEST_READ_SEC);
+        auto request = read_request(client_fd);
+        alarm(0);
+
+        auto memory_mb = request.get_uint("memory", server_descr.memory_mb);
+        if (memory_mb > 0)
+        {
+            rlimit limit{(rlim_t) memory_mb << 20, (rlim_t) memory_mb << 20};
+            setrlimit(RLIMIT_AS, &limit);
+        }
+        if (auto timeout_sec = request.get_uint("timeout", server_descr.timeout_sec); timeout_sec > 0)
+            alarm(timeout_sec);  // (SIGALRM kills the process, the server reports the timeout)
+
+        response = solve_request(request, cache, channel_fd, memory_mb);
+    }
+    catch (const bad_alloc&)
+    {
+        response = format_response({{"status", "MEMOUT"}});
+    }
+    catch (const exception& e)
+    {
+        response = format_response({{"status", "ERROR"}, {"error", e.what()}});
+    }
+
+    write_all(client_fd, response);
+    send_message(channel_fd, "DONE");
+    _exit(0);
+}
+
+
+/**
+ * Apply the complete messages in the buffer (they are removed from the buffer).
+ * The translations are applied as soon as they arrive, i.e., before the response reaches the client.
+ * @return true iff DONE was among them
+ */
+static bool apply_messages(string& buffer, TranslationCache& cache)
+{
+    bool is_done = false;
+    size_t pos = 0;
+    while (true)
+    {
+        auto eol = buffer.find('\n', pos);
+        if (eol == string::npos)
+            break;
+        auto header = split_by_space(buffer.substr(pos, eol - pos));
+        MASSERT(header.size() == 2, "unexpected message header");
+        auto length = (size_t) stoul(header[1]);
+        if (eol + 1 + length > buffer.size())
+            break;  // (not yet complete)
+        auto payload = buffer.substr(eol + 1, length);
+        pos = eol + 1 + length;
+
+        if (header[0] == "CACHE")
+        {
+            auto sep = payload.find('\n');
+            cache.put(payload.substr(0, sep), payload.substr(sep + 1));
+        }
+        else if (header[0] == "HIT")
+            cache.touch(payload);
+        else if (header[0] == "DONE")
+            is_done = true;
+    }
+    buffer.erase(0, pos);
+    return is_done;
+}
+
+
+static int open_socket(const string& socket_path)
+{
+    sockaddr_un addr{};
+    MASSERT(socket_path.size() < sizeof(addr.sun_path), "the socket path is too long: " << socket_path);
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    MASSERT(fd >= 0, "could not create a socket");
+    unlink(socket_path.c_str());  // (a stale socket of a previous run)
+    MASSERT(bind(fd, (sockaddr*) &addr, sizeof(addr)) == 0, "could not bind the socket " << socket_path << ": " << strerror(errno));
+    MASSERT(listen(fd, 64) == 0, "could not listen on the socket");
+    return fd;
+}
+
+
+int sdf::run_server(const ServerDescr& server_descr)
+{
+    MASSERT(server_descr.max_jobs > 0, "the number of jobs must be positive");
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, on_stop_signal);
+    signal(SIGTERM, on_stop_signal);
+
+    int listen_fd = open_socket(server_descr.socket_path);
+    spdlog::info("server: listening on {} ({} jobs)", server_descr.socket_path, server_descr.max_jobs);
+
+    TranslationCache cache(server_descr.cache_size);
+    vector<Job> jobs;
+    while (!is_stopping)
+    {
+        vector<pollfd> fds;
+        for (const auto& job: jobs)
+            fds.push_back({job.channel_fd, POLLIN, 0});
+        bool can_accept = jobs.size() < server_descr.max_jobs;
+        if (can_accept)
+            fds.push_back({listen_fd, POLLIN, 0});
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            MASSERT(errno == EINTR, "poll failed");
+            continue;
+        }
+
+        // messages from the jobs, finished jobs
+        for (size_t j = jobs.size(); j-- > 0; )
+        {
+            auto& job = jobs[j];
+            if (!(fds[j].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            bool is_open = read_some(job.channel_fd, job.buffer);
+            job.is_done |= apply_messages(job.buffer, cache);
+            if (is_open)
+                continue;
+
+            int status = 0;
+            waitpid(job.pid, &status, 0);
+            if (!job.is_done)
+            {   // the process died before responding
+                auto is_timeout = WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM;
+                write_all(job.client_fd,
+                          is_timeout ? format_response({{"status", "TIMEOUT"}})
+                                     : format_response({{"status", "ERROR"},
+                                                        {"error", "the solver died (" + (WIFSIGNALED(status)
+                                                                  ? "signal " + to_string(WTERMSIG(status))
+                                                                  : "exit status " + to_string(WEXITSTATUS(status))) + ")"}}));
+            }
+            close(job.client_fd);
+            close(job.channel_fd);
+            jobs.erase(jobs.begin() + (long) j);
+        }
+
+        // new request
+        if (can_accept && (fds.back().revents & POLLIN))
+        {
+            int client_fd = accept(listen_fd, nullptr, nullptr);
+            if (client_fd < 0)
+                continue;
+
+            int channel[2];
+            MASSERT(pipe(channel) == 0, "could not create a pipe");
+            pid_t pid = fork();
+            MASSERT(pid >= 0, "could not fork");
+            if (pid == 0)
+            {
+                close(listen_fd);
+                close(channel[0]);
+                for (const auto& job: jobs)
+                {
+                    close(job.client_fd);
+                    close(job.channel_fd);
+                }
+                serve_request(server_descr, cache, client_fd, channel[1]);
+            }
+            close(channel[1]);
+            jobs.push_back({pid, client_fd, channel[0], "", false});
+        }
+    }
+
+    spdlog::info("server: stopping");
+    for (auto& job: jobs)
+    {
+        kill(job.pid, SIGKILL);
+        waitpid(job.pid, nullptr, 0);
+        close(job.client_fd);
+        close(job.channel_fd);
+    }
+    close(listen_fd);
+    unlink(server_descr.socket_path.c_str());
+    return 0;
+}
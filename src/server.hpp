@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+
+
+namespace sdf
+{
+
+const uint REQUEST_READ_SEC = 60;  // a client must send its request within this (or the default timeout, if shorter)
+
+struct ServerDescr
+{
+    std::string socket_path;
+    uint max_jobs = 1;            // the number of requests solved concurrently (others wait in the socket backlog)
+    uint timeout_sec = 0;         // default per-request timeout (0 means no timeout)
+    uint memory_mb = 0;           // default per-request memory cap (0 means no cap)
+    uint cache_size = 256;        // the number of LTL->UCW translations kept
+};
+
+/**
+ * Long-lived synthesis server on a Unix domain socket (one request per connection).
+ *
+ * Request: header lines `key: value`, an empty line, then the spec text:
+ *
+ *     format: tlsf             (tlsf or ehoa; default: tlsf)
+ *     k: 2 4                   (default: 4)
+ *     engine: symbolic         (as in sdf-tlsf --engine)
+ *     k-policy: uniform        (as in sdf-tlsf --k-policy)
+ *     ra: false                (as in sdf-tlsf --ra; with the model only)
+ *     extract: abstraction     (as in sdf-tlsf --extract; likewise extract-order, reorder, anytime)
+ *     signal-pruning: true     (false as sdf-tlsf --no-signal-pruning)
+ *     translation-level: medium  (of the LTL->UCW translation: low, medium, high)
+ *     dual: false              (check unrealizability; TLSF only)
+ *     model: true              (extract the model; default: true)
+ *     deadline: 10             (no new k is tried after this many seconds)
+ *     timeout: 30              (the request is killed after this many seconds)
+ *     memory: 2048             (address-space cap in MB; 3/4 of it is the ceiling of the BDD library, see sdf-tlsf --memory)
+ *     length: 1234             (the spec length in bytes; without it, the spec ends when the client shuts down writing)
+ *
+ * Response: header lines, an empty line, then the model in the ASCII AIGER format (if any):
+ *
+ *     status: REALIZABLE       (SYNTCOMP strings, or TIMEOUT, MEMOUT, ERROR)
+ *     k: 4
+ *     time_sec: 0.31
+ *     cached: true             (the UCW came from the translation cache)
+ *     error: ...               (for ERROR)
+ *     length: 5678             (of the model)
+ *
+ * Every request is solved in a process forked from the server,
+ * so it starts warm (the libraries are loaded and initialised, the translation cache is inherited)
+ * and the timeout and the memory cap are enforced by the OS without affecting the server.
+ * (Processes, not threads: spot's BuDDy is a global state and is not thread-safe.)
+ * The translations made by a request are sent back to the server and cached (LRU) for the later requests.
+ *
+ * Runs until SIGINT or SIGTERM.
+ * @return 0 on a clean shutdown
+ */
+int run_server(const ServerDescr& server_descr);
+
+} //namespace sdf
@@ -0,0 +1,106 @@
+#include "signal_pruning.hpp"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+#include "utils.hpp"
+
+
+using namespace std;
+
+
+/** @return the signals sorted by name (for the deterministic order of the model inputs and outputs) */
+static vector<spot::formula> sorted_by_name(const unordered_set<spot::formula>& signals)
+{
+    vector<spot::formula> result(signals.begin(), signals.end());
+    sort(result.begin(), result.end(),
+         [](const spot::formula& a, const spot::formula& b) { return a.ap_name() < b.ap_name(); });
+    return result;
+}
+
+
+/**
+ * @return is_positive: every label(v=0) implies label(v=1), and
+ *         is_negative: every label(v=1) implies label(v=0)
+ */
+static pair<bool, bool> get_unateness(const spot::twa_graph_ptr& aut, int spot_var)
+{
+    bool is_positive = true, is_negative = true;
+    for (const auto& e: aut->edges())
+    {
+        auto low = bdd_restrict(e.cond, bdd_nithvar(spot_var));
+        auto high = bdd_restrict(e.cond, bdd_ithvar(spot_var));
+        is_positive = is_positive && bdd_implies(low, high);
+        is_negative = is_negative && bdd_implies(high, low);
+        if (!is_positive && !is_negative)
+            break;
+    }
+    return {is_positive, is_negative};
+}
+
+
+sdf::PrunedSignals sdf::prune_signals(const spot::twa_graph_ptr& aut,
+                                      const unordered_set<spot::formula>& inputs,
+                                      const unordered_set<spot::formula>& outputs)
+{
+    PrunedSignals pruned;
+    bdd fixed_values = bddtrue;  // (the cube of the fixed signals, absent signals excluded)
+    auto& dict = *aut->get_dict();
+
+    for (const auto& i: sorted_by_name(inputs))
+    {
+        int spot_var = dict.varnum(i);
+        auto [is_positive, is_negative] = spot_var >= 0 ? get_unateness(aut, spot_var) : make_pair(true, true);
+        if (!is_positive && !is_negative)
+        {
+            pruned.inputs.insert(i);
+            continue;
+        }
+        pruned.free_inputs.push_back(i);
+        if (!is_positive || !is_negative)  // (the value enabling more edges)
+            fixed_values &= is_positive ? bdd_ithvar(spot_var) : bdd_nithvar(spot_var);
+    }
+
+    for (const auto& o: sorted_by_name(outputs))
+    {
+        int spot_var = dict.varnum(o);
+        auto [is_positive, is_negative] = spot_var >= 0 ? get_unateness(aut, spot_var) : make_pair(true, true);
+        if (!is_positive && !is_negative)
+        {
+            pruned.outputs.insert(o);
+            continue;
+        }
+        // (the value enabling fewer edges; 0 if the value does not matter)
+        bool value = !is_positive;
+        pruned.fixed_outputs.emplace_back(o, value);
+        if (!is_positive || !is_negative)
+            fixed_values &= value ? bdd_ithvar(spot_var) : bdd_nithvar(spot_var);
+    }
+
+    if (!pruned.free_inputs.empty() || !pruned.fixed_outputs.empty())
+        spdlog::info("prune_signals: inputs not in the game: {}; outputs fixed: {}",
+                     join(", ", pruned.free_inputs, [](const spot::formula& i) { return i.ap_name(); }),
+                     join(", ", pruned.fixed_outputs, [](const pair<spot::formula, bool>& o) { return o.first.ap_name() + "=" + to_string(o.second); }));
+
+    if (fixed_values == bddtrue)
+    {
+        pruned.aut = aut;  // (only the absent signals are pruned: the labels are the same)
+        return pruned;
+    }
+
+    pruned.aut = spot::make_twa_graph(aut, spot::twa::prop_set::all());
+    for (auto& e: pruned.aut->edges())
+        e.cond = bdd_restrict(e.cond, fixed_values);
+    pruned.aut->merge_edges();  // (removes the edges that became false)
+    return pruned;
+}
+
+
+void sdf::restore_signals(aiger* model, const PrunedSignals& pruned)
+{
+    for (const auto& i: pruned.free_inputs)
+        aiger_add_input(model, 2*(model->maxvar + 1), i.ap_name().c_str());
+    for (const auto& [o, value]: pruned.fixed_outputs)
+        aiger_add_output(model, value ? 1 : 0, o.ap_name().c_str());  // (the AIGER literals 0 and 1 are the constants)
+}
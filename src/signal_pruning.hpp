@@ -0,0 +1,47 @@
+#pragma once
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#define BDD spotBDD
+    #include <spot/tl/formula.hh>
+    #include <spot/twa/twagraph.hh>
+#undef BDD
+
+extern "C"
+{
+    #include <aiger.h>
+}
+
+
+namespace sdf
+{
+
+/** the game without the signals that do not matter, and how to put them back into the model */
+struct PrunedSignals
+{
+    spot::twa_graph_ptr aut;                      // the fixed signals are substituted by their values in the labels
+    std::unordered_set<spot::formula> inputs;     // the signals left in the game
+    std::unordered_set<spot::formula> outputs;
+    std::vector<spot::formula> free_inputs;                     // the inputs not in the game (the model ignores them)
+    std::vector<std::pair<spot::formula, bool>> fixed_outputs;  // the outputs not in the game, with their constant values
+};
+
+/**
+ * Drop the signals that the game does not need (e.g., those the formula never mentions).
+ * A signal goes if every label of the UCW is unate in it, i.e., its one value enables at least the edges the other value does:
+ * - an output is fixed to the value enabling fewer edges (fewer runs of a universal automaton can only help Eve),
+ * - an input is fixed to the value enabling more edges (the worst for Eve: the model is correct for the other value too),
+ * - a signal absent from the labels is unate both ways: an absent output is fixed to 0, an absent input is simply dropped.
+ * This preserves the verdict, for Moore and Mealy games alike.
+ * (`aut` is not modified: the result holds a copy if some signal is fixed.)
+ */
+PrunedSignals prune_signals(const spot::twa_graph_ptr& aut,
+                            const std::unordered_set<spot::formula>& inputs,
+                            const std::unordered_set<spot::formula>& outputs);
+
+/** add the pruned signals to the model of the pruned game: the dropped inputs as inputs, the fixed outputs as constants */
+void restore_signals(aiger* model, const PrunedSignals& pruned);
+
+} //namespace sdf
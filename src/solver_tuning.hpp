@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <sys/types.h>
+
+
+namespace sdf
+{
+
+/** the optimisation level of the LTL->UCW translation (spot::postprocessor) */
+enum class TranslationLevel
+{
+    low,
+    medium,
+    high
+};
+
+const uint EXTRACT_TRY_SEC = 10;  // ExtractMethod::best: the time limit of every method for every output
+
+/** how the output functions are extracted from the non-deterministic strategy (see GameSolver::extract_output_funcs) */
+enum class ExtractMethod
+{
+    abstraction,    // quantify away the variables the output does not depend on (in the reachable states), then restrict
+    squeeze,        // a small BDD between must-be-true and not-must-be-false (Cudd_bddSqueeze)
+    li_compaction,  // must-be-true simplified on the care set (Cudd_bddLICompaction)
+    isop,           // an irredundant sum-of-products cover between must-be-true and not-must-be-false (Cudd_bddIsop)
+    restrict,       // must-be-true restricted to the care set (Cudd_bddRestrict)
+    constrain,      // must-be-true constrained by the care set (Cudd_bddConstrain)
+    best            // try all of them for every output (each within EXTRACT_TRY_SEC) and keep the smallest BDD
+};
+
+const uint EXTRACT_ORDER_SEC = 60;  // ExtractOrder::greedy/search: the time budget of the search for the order
+
+/** the order in which the outputs are concretised (see GameSolver::extract_output_funcs) */
+enum class ExtractOrder
+{
+    fixed,   // the outputs in the reverse order of their declaration
+    greedy,  // at every step, the output whose function is the smallest (all remaining outputs are extracted to compare)
+    search   // fixed, reversed, and greedy, one after another while the budget lasts; the smallest model wins
+};
+
+/** the dynamic variable reordering of CUDD */
+enum class ReorderPolicy
+{
+    off,       // none (neither dynamic nor before the AIGER is built)
+    sift,      // sifting while solving, and in the extraction iff reorder_in_extraction; one converging pass before the AIGER
+    adaptive   // the method and the frequency adapt to the observed gains, in every phase (see AdaptiveReordering)
+};
+
+/**
+ * The knobs that do not change the verdict but do change the time and the circuit size,
+ * and no setting of which wins on every spec (see run_portfolio).
+ */
+struct SolverTuning
+{
+    TranslationLevel translation_level = TranslationLevel::medium;
+    ExtractMethod extract_method = ExtractMethod::abstraction;
+    ExtractOrder extract_order = ExtractOrder::fixed;
+    ReorderPolicy reorder_policy = ReorderPolicy::sift;
+    bool reorder_in_extraction = false;  // keep the dynamic reordering (sifting) after the winning region is computed
+    uint memory_mb = 0;                  // >0: the memory ceiling of CUDD, with the cheaper paths under pressure (see GameSolver::degrade_for_memory)
+    uint anytime_sec = 0;                // >0: a cheap model first, improved while the solver runs for less than this (see GameSolver::synthesize_anytime)
+    bool prune_signals = true;           // the signals that do not matter are not in the game (see prune_signals)
+
+    // (not knobs, but they travel the same way)
+    std::string checkpoint_file;  // save the winning region and the strategy there, the output functions to checkpoint_file.outputs (see GameSolver::synthesize)
+    bool resume = false;          // start from checkpoint_file if it is of the same game
+    bool re_extract = false;      // when resuming, extract the output functions anew rather than load them
+};
+
+} //namespace sdf
@@ -0,0 +1,167 @@
+#include "synthesis_api.hpp"
+
+#include <chrono>
+#include <mutex>
+
+#include "ltl_parser.hpp"
+#include "ehoa_parser.hpp"
+#include "my_assert.hpp"
+
+
+using namespace std;
+using namespace sdf;
+
+
+#define hset unordered_set
+
+
+using Clock = chrono::steady_clock;
+
+
+static mutex spot_mutex;  // (spot's BuDDy is not thread-safe)
+
+
+static double sec_since(Clock::time_point start)
+{
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+static int put_char(char c, void* state)
+{
+    ((string*) state)->push_back(c);
+    return c;
+}
+
+
+string SynthResult::model_as_aag() const
+{
+    string text;
+    if (model)
+        MASSERT(aiger_write_generic(model.get(), aiger_ascii_mode, &text, put_char), "could not write the model");
+    return text;
+}
+
+
+/** (the caller holds spot_mutex) */
+static SynthResult solve_ucw(const spot::twa_graph_ptr& ucw,
+                             const hset<spot::formula>& inputs,
+                             const hset<spot::formula>& outputs,
+                             bool is_moore,
+                             const SynthOptions& options,
+                             const CancellationToken* cancellation,
+                             SynthResult result)
+{
+    auto is_cancelled = [&]() { return cancellation != nullptr && cancellation->is_cancelled(); };
+
+    result.ucw_nof_states = ucw->num_states();
+    if (is_cancelled())
+    {
+        result.verdict = Verdict::cancelled;
+        return result;
+    }
+
+    auto start = Clock::now();
+    aiger* model = nullptr;
+    SynthStats stats;
+    bool is_real;
+    try
+    {
+        is_real = synthesize_atm(SpecDescr2(ucw, inputs, outputs, is_moore, options.extract_model, options.do_reach_optim,
+                                            options.engine, options.k_policy, options.deadline_sec,
+                                            cancellation != nullptr ? cancellation->get_flag() : nullptr, options.tuning),
+                                 options.k_to_iterate, model, &stats);
+    }
+    catch (const logic_error&)
+    {
+        if (!is_cancelled())
+            throw;
+        is_real = false;  // (CUDD aborted the operation)
+    }
+    result.solving_sec = sec_since(start);
+    result.k = stats.k;
+    result.nof_games = stats.nof_games;
+    result.memory_fallbacks = stats.memory_fallbacks;
+
+    if (!is_real)
+        result.verdict = is_cancelled() ? Verdict::cancelled : Verdict::unknown;
+    else
+        result.verdict = options.check_unreal ? Verdict::unrealizable : Verdict::realizable;
+
+    if (model != nullptr)
+        result.model = shared_ptr<aiger>(model, aiger_reset);
+    return result;
+}
+
+
+/** (the caller holds spot_mutex) */
+static SynthResult solve_ltl(spot::formula formula,
+                             hset<spot::formula> inputs,
+                             hset<spot::formula> outputs,
+                             bool is_moore,
+                             const SynthOptions& options,
+                             const CancellationToken* cancellation,
+                             Clock::time_point start)
+{
+    if (options.check_unreal)
+    {   // (as in run_tlsf)
+        formula = spot::formula::Not(formula);
+        swap(inputs, outputs);
+        is_moore = !is_moore;
+    }
+    auto ucw = translate_to_ucw(formula, options.tuning.translation_level);
+
+    SynthResult result;
+    result.translation_sec = sec_since(start);
+    return solve_ucw(ucw, inputs, outputs, is_moore, options, cancellation, result);
+}
+
+
+SynthResult sdf::synthesize_tlsf_text(const string& tlsf_text,
+                                      const SynthOptions& options,
+                                      const CancellationToken* cancellation)
+{
+    lock_guard<mutex> lock(spot_mutex);
+    auto start = Clock::now();
+    auto [formula, inputs, outputs, is_moore] = parse_tlsf_string(tlsf_text);
+    return solve_ltl(formula, inputs, outputs, is_moore, options, cancellation, start);
+}
+
+
+SynthResult sdf::synthesize_ltl(const spot::formula& formula,
+                                const hset<spot::formula>& inputs,
+                                const hset<spot::formula>& outputs,
+                                bool is_moore,
+                                const SynthOptions& options,
+                                const CancellationToken* cancellation)
+{
+    lock_guard<mutex> lock(spot_mutex);
+    return solve_ltl(formula, inputs, outputs, is_moore, options, cancellation, Clock::now());
+}
+
+
+SynthResult sdf::synthesize_ehoa_text(const string& ehoa_text,
+                                      const SynthOptions& options,
+                                      const CancellationToken* cancellation)
+{
+    MASSERT(!options.check_unreal, "the unrealizability check is supported for LTL specs only");
+    lock_guard<mutex> lock(spot_mutex);
+    auto start = Clock::now();
+    auto [ucw, inputs, outputs, is_moore] = read_ehoa_text(ehoa_text);
+    SynthResult result;
+    result.translation_sec = sec_since(start);
+    return solve_ucw(ucw, inputs, outputs, is_moore, options, cancellation, result);
+}
+
+
+SynthResult sdf::synthesize_ucw(const spot::twa_graph_ptr& ucw,
+                                const hset<spot::formula>& inputs,
+                                const hset<spot::formula>& outputs,
+                                bool is_moore,
+                                const SynthOptions& options,
+                                const CancellationToken* cancellation)
+{
+    MASSERT(!options.check_unreal, "the unrealizability check is supported for LTL specs only");
+    lock_guard<mutex> lock(spot_mutex);
+    return solve_ucw(ucw, inputs, outputs, is_moore, options, cancellation, SynthResult());
+}
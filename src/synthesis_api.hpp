@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#define BDD spotBDD
+    #include <spot/tl/formula.hh>
+    #include <spot/twa/twagraph.hh>
+#undef BDD
+
+extern "C"
+{
+    #include <aiger.h>
+}
+
+#include "synthesizer.hpp"
+
+
+/**
+ * In-memory API for embedding the synthesizer:
+ * the specs are strings or spot objects, the results are returned as objects,
+ * nothing is printed to stdout (the log goes to spdlog's default logger, configure it as you like)
+ * and no files are read or written.
+ *
+ * The calls can be made from several threads, but they are serialised:
+ * spot's BuDDy is a global state and is not thread-safe.
+ * Errors in the spec are reported by throwing std::logic_error (as everywhere in sdf).
+ */
+
+namespace sdf
+{
+
+class CancellationToken
+{
+public:
+    void cancel() { flag = true; }
+    bool is_cancelled() const { return flag; }
+    const std::atomic<bool>* get_flag() const { return &flag; }
+
+private:
+    std::atomic<bool> flag = false;
+};
+
+enum class Verdict
+{
+    realizable,
+    unrealizable,  // (only when SynthOptions::check_unreal)
+    unknown,       // Adam wins for all tried k (the spec can be realizable with larger k)
+    cancelled      // the token was cancelled (the translation LTL->UCW is not interrupted, the game solving is)
+};
+
+struct SynthOptions
+{
+    std::vector<uint> k_to_iterate = {4};
+    SolverEngine engine = SolverEngine::symbolic;
+    KBoundPolicy k_policy = KBoundPolicy::uniform;
+    uint deadline_sec = 0;        // no new k is tried after the deadline (0 means no deadline)
+    bool extract_model = true;
+    bool do_reach_optim = false;
+    bool check_unreal = false;    // solve the dualized spec (LTL specs only)
+    SolverTuning tuning;
+};
+
+struct SynthResult
+{
+    Verdict verdict = Verdict::unknown;
+    uint k = 0;                   // see SynthStats
+    uint nof_games = 0;
+    std::vector<std::string> memory_fallbacks;  // see SynthStats
+    uint ucw_nof_states = 0;
+    double translation_sec = 0;   // (parsing and LTL->UCW)
+    double solving_sec = 0;
+    std::shared_ptr<aiger> model; // (set iff the model was requested and the verdict is realizable or unrealizable)
+
+    /** @return the model in the ASCII AIGER format (empty if there is no model) */
+    std::string model_as_aag() const;
+};
+
+SynthResult synthesize_tlsf_text(const std::string& tlsf_text,
+                                 const SynthOptions& options,
+                                 const CancellationToken* cancellation = nullptr);
+
+/** (check_unreal is not supported) */
+SynthResult synthesize_ehoa_text(const std::string& ehoa_text,
+                                 const SynthOptions& options,
+                                 const CancellationToken* cancellation = nullptr);
+
+SynthResult synthesize_ltl(const spot::formula& formula,
+                           const std::unordered_set<spot::formula>& inputs,
+                           const std::unordered_set<spot::formula>& outputs,
+                           bool is_moore,
+                           const SynthOptions& options,
+                           const CancellationToken* cancellation = nullptr);
+
+/** @param ucw: the universal co-Buchi automaton with state-based acceptance (check_unreal is not supported) */
+SynthResult synthesize_ucw(const spot::twa_graph_ptr& ucw,
+                           const std::unordered_set<spot::formula>& inputs,
+                           const std::unordered_set<spot::formula>& outputs,
+                           bool is_moore,
+                           const SynthOptions& options,
+                           const CancellationToken* cancellation = nullptr);
+
+} //namespace sdf
@@ -1,7 +1,12 @@
 #include "synthesizer.hpp"
 
 #include "game_solver.hpp"
+#include "explicit_game_solver.hpp"
+#include "local_game_solver.hpp"
+#include "antichain_game_solver.hpp"
+#include "counter_game_solver.hpp"
 #include "k_reduce.hpp"
+#include "signal_pruning.hpp"
 #include "ltl_parser.hpp"
 #include "ehoa_parser.hpp"
 #include "utils.hpp"
@@ -13,6 +18,8 @@
     #include <spot/twaalgos/dot.hh>
     #include <spot/twaalgos/translate.hh>
     #include <spot/twaalgos/simulation.hh>
+    #include <spot/twaalgos/sccinfo.hh>
+    #include <spot/twaalgos/isdet.hh>
 //    #include <spot/parseaut/public.hh>
 #undef BDD
 
@@ -33,13 +40,63 @@ using namespace sdf;
 #define hset unordered_set
 
 
+const unordered_map<string, SolverEngine>& sdf::get_engine_by_name()
+{
+    static const unordered_map<string, SolverEngine> engine_by_name =
+        {{"symbolic", SolverEngine::symbolic}, {"counters", SolverEngine::counters}, {"explicit", SolverEngine::explicit_state},
+         {"local", SolverEngine::local}, {"antichain", SolverEngine::antichain}, {"auto", SolverEngine::automatic}};
+    return engine_by_name;
+}
+
+
+const unordered_map<string, KBoundPolicy>& sdf::get_k_policy_by_name()
+{
+    static const unordered_map<string, KBoundPolicy> k_policy_by_name =
+        {{"uniform", KBoundPolicy::uniform}, {"balanced", KBoundPolicy::balanced}, {"feedback", KBoundPolicy::feedback}};
+    return k_policy_by_name;
+}
+
+
+const unordered_map<string, ExtractMethod>& sdf::get_extract_method_by_name()
+{
+    static const unordered_map<string, ExtractMethod> extract_method_by_name =
+        {{"abstraction", ExtractMethod::abstraction}, {"squeeze", ExtractMethod::squeeze}, {"li-compaction", ExtractMethod::li_compaction},
+         {"isop", ExtractMethod::isop}, {"restrict", ExtractMethod::restrict}, {"constrain", ExtractMethod::constrain},
+         {"best", ExtractMethod::best}};
+    return extract_method_by_name;
+}
+
+
+const unordered_map<string, ExtractOrder>& sdf::get_extract_order_by_name()
+{
+    static const unordered_map<string, ExtractOrder> extract_order_by_name =
+        {{"fixed", ExtractOrder::fixed}, {"greedy", ExtractOrder::greedy}, {"search", ExtractOrder::search}};
+    return extract_order_by_name;
+}
+
+
+const unordered_map<string, ReorderPolicy>& sdf::get_reorder_policy_by_name()
+{
+    static const unordered_map<string, ReorderPolicy> reorder_policy_by_name =
+        {{"off", ReorderPolicy::off}, {"sift", ReorderPolicy::sift}, {"adaptive", ReorderPolicy::adaptive}};
+    return reorder_policy_by_name;
+}
+
+
+const unordered_map<string, TranslationLevel>& sdf::get_translation_level_by_name()
+{
+    static const unordered_map<string, TranslationLevel> translation_level_by_name =
+        {{"low", TranslationLevel::low}, {"medium", TranslationLevel::medium}, {"high", TranslationLevel::high}};
+    return translation_level_by_name;
+}
+
+
 int sdf::run_hoa(const SpecDescr& spec_descr,
                  const std::vector<uint>& k_to_iterate)
 {
     auto [aut, inputs, outputs, is_moore] = read_ehoa(spec_descr.file_name);
 
-    // TODO: what happens when tlsf does have inputs/outputs but the formula doesn't mention them?
-    //       (should still have it)
+    // (the signals that the automaton does not mention are not in the game, but the model has them: see prune_signals)
 
     spdlog::info("\n"
         "  hoa: {}\n"
@@ -56,7 +113,7 @@ int sdf::run_hoa(const SpecDescr& spec_descr,
     }
 
     aiger* model;
-    bool game_is_real = synthesize_atm(SpecDescr2(aut, inputs, outputs, is_moore, spec_descr.extract_model, spec_descr.do_reach_optim), k_to_iterate, model);
+    bool game_is_real = synthesize_atm(SpecDescr2(aut, inputs, outputs, is_moore, spec_descr.extract_model, spec_descr.do_reach_optim, spec_descr.engine, spec_descr.k_policy, spec_descr.deadline_sec, nullptr, spec_descr.tuning), k_to_iterate, model);
 
     if (!game_is_real)
     {   // game is won by Adam, but it does not mean the invoked spec is unrealizable (due to k-reduction)
@@ -93,8 +150,7 @@ int sdf::run_tlsf(const SpecDescr& spec_descr,
     bool is_moore;
     tie(formula, inputs, outputs, is_moore) = parse_tlsf(spec_descr.file_name);
 
-    // TODO: what happens when TLSF does have inputs/outputs but the formula doesn't mention them?
-    //       (should still have it)
+    // (the signals that the formula does not mention are not in the game, but the model has them: see prune_signals)
 
     spdlog::info("\n"
         "  tlsf: {}\n"
@@ -108,8 +164,8 @@ int sdf::run_tlsf(const SpecDescr& spec_descr,
     aiger* model;
     bool game_is_real;
     game_is_real = spec_descr.check_unreal?
-            synthesize_formula(SpecDescr2(spot::formula::Not(formula), outputs, inputs, !is_moore, spec_descr.extract_model, spec_descr.do_reach_optim), k_to_iterate, model):
-            synthesize_formula(SpecDescr2(formula, inputs, outputs, is_moore, spec_descr.extract_model, spec_descr.do_reach_optim), k_to_iterate, model);
+            synthesize_formula(SpecDescr2(spot::formula::Not(formula), outputs, inputs, !is_moore, spec_descr.extract_model, spec_descr.do_reach_optim, spec_descr.engine, spec_descr.k_policy, spec_descr.deadline_sec, nullptr, spec_descr.tuning), k_to_iterate, model):
+            synthesize_formula(SpecDescr2(formula, inputs, outputs, is_moore, spec_descr.extract_model, spec_descr.do_reach_optim, spec_descr.engine, spec_descr.k_policy, spec_descr.deadline_sec, nullptr, spec_descr.tuning), k_to_iterate, model);
 
     if (!game_is_real)
     {   // game is won by Adam, but it does not mean the invoked spec is unrealizable (due to k-reduction)
@@ -141,65 +197,387 @@ int sdf::run_tlsf(const SpecDescr& spec_descr,
 }
 
 
-bool sdf::synthesize_atm(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
-                         const std::vector<uint>& k_to_iterate,
-                         aiger*& model)
+/**
+ * The symbolic engine pays for every state of the k-reduced automaton with a BDD variable,
+ * which does not scale when the automaton is large, whereas the antichains
+ * explore only the nodes reachable from the initial one and prune the dominated nodes.
+ * The estimate of the k-reduced automaton size: the states of the SCCs with rejecting states are copied k+1 times.
+ * Also, when the UCW is deterministic, all nodes are singletons and the antichain engine explores them directly.
+ */
+static SolverEngine choose_engine(const spot::twa_graph_ptr& ucw, const vector<uint>& k_by_scc)
 {
-    for (auto k: k_to_iterate)
+    spot::scc_info scc_info(ucw);
+    ulong estimated_nof_states = 0;
+    for (uint scc = 0; scc < scc_info.scc_count(); ++scc)
     {
-        spdlog::info("trying k = {}", k);
-        auto k_aut = k_reduce(spec_descr.spec, k);
-
-        MASSERT(k_aut->is_sba() == spot::trival::yes_value, "is the automaton with Buchi-state acceptance?");
-        MASSERT(k_aut->prop_terminal() == spot::trival::yes_value, "is the automaton terminal?");
-
-        spdlog::info("automaton before sim/cosim reduction: {} states, {} edges", k_aut->num_states(), k_aut->num_edges());
-        auto reduced_k_aut = spot::reduce_iterated_sba(k_aut);
-        reduced_k_aut->copy_named_properties_of(k_aut);    // TODO: strange: bug?: ask Ald about this (on lilydemo13.tlsf, the properties are not copied)
-        reduced_k_aut->copy_acceptance_of(k_aut);          // TODO: strange: bug?: ask Ald about this
-        k_aut = reduced_k_aut;
-        MASSERT(k_aut->is_sba() == spot::trival::yes_value, "is the automaton with Buchi-state acceptance?");
-        MASSERT(k_aut->prop_terminal() == spot::trival::yes_value, "is the automaton terminal?");
-        spdlog::info("... after sim/cosim reduction: {} states, {} edges", k_aut->num_states(), k_aut->num_edges());
-
-        {   // debug
-            stringstream ss;
-            spot::print_dot(ss, k_aut);
-            spdlog::debug("\n{}", ss.str());
-        }
+        const auto& scc_states = scc_info.states_of(scc);
+        bool has_rejecting = any_of(scc_states.begin(), scc_states.end(),
+                                    [&](uint q) { return ucw->state_is_accepting(q); });
+        estimated_nof_states += scc_states.size() * (has_rejecting ? k_by_scc[scc]+1 : 1);
+    }
+
+    auto engine = (estimated_nof_states > ANTICHAIN_BOUND || spot::count_nondet_states(ucw) == 0)
+                  ? SolverEngine::antichain
+                  : SolverEngine::symbolic;
+    spdlog::info("choose_engine: estimated size of the k-reduced automaton is {} states, using the {} engine",
+                 estimated_nof_states, engine == SolverEngine::antichain ? "antichain" : "symbolic");
+    return engine;
+}
+
+
+static spot::twa_graph_ptr reduce_to_safety(const spot::twa_graph_ptr& ucw, const vector<uint>& k_by_scc)
+{
+    auto k_aut = k_reduce(ucw, k_by_scc);
 
-        GameSolver solver(spec_descr.is_moore, spec_descr.inputs, spec_descr.outputs, k_aut,
-                          spec_descr.do_reach_optim && (k_aut->num_states()<=R_OPTIM_BOUND),
-                          3600);
+    MASSERT(k_aut->is_sba() == spot::trival::yes_value, "is the automaton with Buchi-state acceptance?");
+    MASSERT(k_aut->prop_terminal() == spot::trival::yes_value, "is the automaton terminal?");
+
+    spdlog::info("automaton before sim/cosim reduction: {} states, {} edges", k_aut->num_states(), k_aut->num_edges());
+    auto reduced_k_aut = spot::reduce_iterated_sba(k_aut);
+    reduced_k_aut->copy_named_properties_of(k_aut);    // TODO: strange: bug?: ask Ald about this (on lilydemo13.tlsf, the properties are not copied)
+    reduced_k_aut->copy_acceptance_of(k_aut);          // TODO: strange: bug?: ask Ald about this
+    k_aut = reduced_k_aut;
+    MASSERT(k_aut->is_sba() == spot::trival::yes_value, "is the automaton with Buchi-state acceptance?");
+    MASSERT(k_aut->prop_terminal() == spot::trival::yes_value, "is the automaton terminal?");
+    spdlog::info("... after sim/cosim reduction: {} states, {} edges", k_aut->num_states(), k_aut->num_edges());
+
+    {   // debug
+        stringstream ss;
+        spot::print_dot(ss, k_aut);
+        spdlog::debug("\n{}", ss.str());
+    }
+
+    return k_aut;
+}
+
+
+static unique_ptr<GameSolver> make_solver_for_engine(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                                                     const vector<uint>& k_by_scc)
+{
+    auto engine = spec_descr.engine != SolverEngine::automatic
+                  ? spec_descr.engine
+                  : spec_descr.k_policy == KBoundPolicy::feedback
+                    ? SolverEngine::antichain  // (the only one with the witness of the loss)
+                    : choose_engine(spec_descr.spec, k_by_scc);
+
+    if (engine == SolverEngine::antichain)
+        return make_unique<AntichainGameSolver>(spec_descr.is_moore, spec_descr.inputs, spec_descr.outputs, spec_descr.spec,
+                                                k_by_scc, 3600);
+    if (engine == SolverEngine::counters)
+        return make_unique<CounterGameSolver>(spec_descr.is_moore, spec_descr.inputs, spec_descr.outputs, spec_descr.spec,
+                                              k_by_scc, spec_descr.do_reach_optim,
+                                              3600);
+
+    auto k_aut = reduce_to_safety(spec_descr.spec, k_by_scc);
+    if (engine == SolverEngine::explicit_state)
+        return make_unique<ExplicitGameSolver>(spec_descr.is_moore, spec_descr.inputs, spec_descr.outputs, k_aut,
+                                               spec_descr.do_reach_optim, 3600);
+    if (engine == SolverEngine::local)
+        return make_unique<LocalGameSolver>(spec_descr.is_moore, spec_descr.inputs, spec_descr.outputs, k_aut,
+                                            spec_descr.do_reach_optim, 3600);
+    return make_unique<GameSolver>(spec_descr.is_moore, spec_descr.inputs, spec_descr.outputs, k_aut,
+                                   spec_descr.do_reach_optim, 3600);
+}
+
+
+static unique_ptr<GameSolver> make_solver(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                                          const vector<uint>& k_by_scc)
+{
+    auto solver = make_solver_for_engine(spec_descr, k_by_scc);
+    solver->set_cancel_flag(spec_descr.cancel_flag);
+    solver->set_tuning(spec_descr.tuning);
+    return solver;
+}
+
+
+/**
+ * @return true iff Eve wins the game with the given bounds (then `model` is set if the model is requested);
+ *         otherwise `exhausted_sccs` is set to the witness of the loss (see GameSolver::get_exhausted_sccs)
+ */
+static bool solve_for_bounds(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                             const vector<uint>& k_by_scc,
+                             aiger*& model,
+                             optional<set<uint>>& exhausted_sccs,
+                             SynthStats& stats)
+{
+    spdlog::info("k by SCC: {}", join(", ", k_by_scc));
+
+    auto solver = make_solver(spec_descr, k_by_scc);
+    auto add_fallbacks = [&]()
+    {
+        const auto& fallbacks = solver->get_memory_fallbacks();
+        stats.memory_fallbacks.insert(stats.memory_fallbacks.end(), fallbacks.begin(), fallbacks.end());
+    };
+
+    bool is_real;
+    try
+    {
         if (spec_descr.extract_model)
         {
-            model = solver.synthesize();
-            if (model != nullptr)
-                return true;
+            model = solver->synthesize();
+            is_real = model != nullptr;
         }
         else
+            is_real = solver->check_realizability();
+    }
+    catch (const logic_error&)
+    {
+        if (!solver->is_out_of_memory())
+            throw;
+        add_fallbacks();
+        throw bad_alloc();  // (the solver, and so its memory, is gone after this)
+    }
+    add_fallbacks();
+
+    if (!is_real)
+        exhausted_sccs = solver->get_exhausted_sccs();
+    return is_real;
+}
+
+
+static vector<uint> get_k_by_scc(const SpecDescr2<spot::twa_graph_ptr>& spec_descr, uint k)
+{
+    return spec_descr.k_policy == KBoundPolicy::balanced
+           ? balanced_k_by_scc(spec_descr.spec, k)
+           : uniform_k_by_scc(spec_descr.spec, k);
+}
+
+
+/**
+ * SolverTuning::memory_mb: the game for k ran out of memory, so try the k halfway between the last lost k and k,
+ * and so on down to the lost k + 1. (No larger k is tried afterwards: it would run out of memory as well.)
+ * @return true iff Eve wins with one of them
+ */
+static bool retry_with_smaller_k(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                                 uint lost_k,
+                                 uint k,
+                                 aiger*& model,
+                                 SynthStats& stats)
+{
+    while (true)
+    {
+        auto smaller_k = lost_k + (k - lost_k) / 2;
+        if (smaller_k <= lost_k)
+        {
+            spdlog::warn("memory: k = {} ran out of memory, and no smaller k is left to try", k);
+            return false;
+        }
+        spdlog::warn("memory: k = {} ran out of memory, trying k = {}", k, smaller_k);
+        stats.memory_fallbacks.push_back("k = " + to_string(smaller_k) + " instead of " + to_string(k));
+
+        optional<set<uint>> exhausted_sccs;
+        ++stats.nof_games;
+        try
+        {
+            if (!solve_for_bounds(spec_descr, get_k_by_scc(spec_descr, smaller_k), model, exhausted_sccs, stats))
+                return false;
+            stats.k = smaller_k;
+            return true;
+        }
+        catch (const bad_alloc&)
+        {
+            k = smaller_k;
+        }
+    }
+}
+
+
+/**
+ * retry_with_smaller_k for the bounds by SCC of the feedback policy:
+ * every bound goes halfway between the last lost bound and the bound that ran out of memory.
+ */
+static bool retry_with_smaller_bounds(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                                      const vector<uint>& lost_k_by_scc,
+                                      vector<uint> k_by_scc,
+                                      aiger*& model,
+                                      SynthStats& stats)
+{
+    while (true)
+    {
+        vector<uint> smaller_k_by_scc(k_by_scc.size());
+        for (uint scc = 0; scc < k_by_scc.size(); ++scc)
+            smaller_k_by_scc[scc] = lost_k_by_scc[scc] + (k_by_scc[scc] - lost_k_by_scc[scc]) / 2;
+        if (smaller_k_by_scc == lost_k_by_scc)
+        {
+            spdlog::warn("memory: k by SCC = {} ran out of memory, and no smaller bounds are left to try", join(", ", k_by_scc));
+            return false;
+        }
+        spdlog::warn("memory: k by SCC = {} ran out of memory, trying {}", join(", ", k_by_scc), join(", ", smaller_k_by_scc));
+        stats.memory_fallbacks.push_back("k by SCC = " + join(", ", smaller_k_by_scc) + " instead of " + join(", ", k_by_scc));
+
+        optional<set<uint>> exhausted_sccs;
+        ++stats.nof_games;
+        try
         {
-            if (solver.check_realizability())
+            if (!solve_for_bounds(spec_descr, smaller_k_by_scc, model, exhausted_sccs, stats))
+                return false;
+            stats.k = *max_element(smaller_k_by_scc.begin(), smaller_k_by_scc.end());
+            return true;
+        }
+        catch (const bad_alloc&)
+        {
+            k_by_scc = smaller_k_by_scc;
+        }
+    }
+}
+
+
+static bool is_past_deadline(const WallTimer& timer, uint deadline_sec, const atomic<bool>* cancel_flag)
+{
+    if (cancel_flag != nullptr && cancel_flag->load())
+    {
+        spdlog::info("cancelled, no more k is tried");
+        return true;
+    }
+    if (deadline_sec == 0 || timer.sec_from_origin() < deadline_sec)
+        return false;
+    spdlog::info("the deadline ({} sec) is reached, no more k is tried", deadline_sec);
+    return true;
+}
+
+
+/**
+ * Start with the smallest k for every SCC.
+ * When Adam wins, raise the bounds (k -> 2k+1) of the SCCs whose budget got exhausted in the losing plays,
+ * but never above the largest k.
+ * Only the antichain engine tells the exhausted SCCs (the others work on the k-reduced automaton, whose states,
+ * after the simulation-based reduction, no longer map to the budgets of the UCW), hence it is required.
+ * Stop when no bound can be raised: either all exhausted SCCs are at the ceiling,
+ * or no budget got exhausted (Adam wins by reaching the accepting sinks, so larger bounds would not help).
+ */
+static bool synthesize_atm_with_feedback(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                                         const vector<uint>& k_to_iterate,
+                                         aiger*& model,
+                                         SynthStats& stats)
+{
+    MASSERT(spec_descr.engine == SolverEngine::antichain || spec_descr.engine == SolverEngine::automatic,
+            "the feedback k-policy needs the witness of the loss, which only the antichain engine gives");
+
+    WallTimer timer;
+    auto ceiling = *max_element(k_to_iterate.begin(), k_to_iterate.end());
+    auto k_by_scc = uniform_k_by_scc(spec_descr.spec, *min_element(k_to_iterate.begin(), k_to_iterate.end()));
+    vector<uint> lost_k_by_scc(k_by_scc.size(), 0);
+    while (true)
+    {
+        optional<set<uint>> exhausted_sccs;
+        ++stats.nof_games;
+        try
+        {
+            if (solve_for_bounds(spec_descr, k_by_scc, model, exhausted_sccs, stats))
+            {
+                stats.k = *max_element(k_by_scc.begin(), k_by_scc.end());
                 return true;
+            }
         }
+        catch (const bad_alloc&)
+        {
+            if (spec_descr.tuning.memory_mb == 0)
+                throw;
+            return retry_with_smaller_bounds(spec_descr, lost_k_by_scc, k_by_scc, model, stats);
+        }
+        lost_k_by_scc = k_by_scc;
+
+        MASSERT(exhausted_sccs.has_value(), "the solver gave no witness of the loss");
+        spdlog::info("feedback: exhausted SCCs: {}", join(", ", *exhausted_sccs));
+
+        bool is_raised = false;
+        for (auto scc: *exhausted_sccs)
+            if (k_by_scc[scc] < ceiling)
+            {
+                k_by_scc[scc] = min(ceiling, 2*k_by_scc[scc] + 1);
+                is_raised = true;
+            }
+        if (!is_raised)
+        {
+            spdlog::info("feedback: no bound can be raised (the ceiling is {})", ceiling);
+            return false;
+        }
+
+        if (is_past_deadline(timer, spec_descr.deadline_sec, spec_descr.cancel_flag))
+            return false;
+    }
+}
+
+
+/** synthesize_atm for the signals as they are (pruned or not) */
+static bool synthesize_atm_for(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                               const vector<uint>& k_to_iterate,
+                               aiger*& model,
+                               SynthStats* stats)
+{
+    if (spec_descr.k_policy == KBoundPolicy::feedback)
+        return synthesize_atm_with_feedback(spec_descr, k_to_iterate, model, *stats);
+
+    WallTimer timer;
+    uint lost_k = 0;
+    for (auto k: k_to_iterate)
+    {
+        if (is_past_deadline(timer, spec_descr.deadline_sec, spec_descr.cancel_flag))
+            return false;
+
+        spdlog::info("trying k = {}", k);
+
+        optional<set<uint>> exhausted_sccs;
+        ++stats->nof_games;
+        try
+        {
+            if (solve_for_bounds(spec_descr, get_k_by_scc(spec_descr, k), model, exhausted_sccs, *stats))
+            {
+                stats->k = k;
+                return true;
+            }
+        }
+        catch (const bad_alloc&)
+        {
+            if (spec_descr.tuning.memory_mb == 0)
+                throw;
+            return retry_with_smaller_k(spec_descr, lost_k, k, model, *stats);
+        }
+        lost_k = k;
     }
 
     return false;
 }
 
 
-bool sdf::synthesize_formula(const SpecDescr2<spot::formula>& spec_descr,
-                             const std::vector<uint>& k_to_iterate,
-                             aiger*& model)
+bool sdf::synthesize_atm(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
+                         const std::vector<uint>& k_to_iterate,
+                         aiger*& model,
+                         SynthStats* stats)
 {
-    spot::formula neg_formula = spot::formula::Not(spec_descr.spec);
+    SynthStats local_stats;
+    if (stats == nullptr)
+        stats = &local_stats;
+
+    if (!spec_descr.tuning.prune_signals)
+        return synthesize_atm_for(spec_descr, k_to_iterate, model, stats);
+
+    // the signals that do not matter are not in the game (every one costs a BDD variable quantified in every step),
+    // and the model gets them back
+    auto pruned = prune_signals(spec_descr.spec, spec_descr.inputs, spec_descr.outputs);
+    bool is_real = synthesize_atm_for(SpecDescr2(pruned.aut, pruned.inputs, pruned.outputs, spec_descr.is_moore, spec_descr.extract_model, spec_descr.do_reach_optim, spec_descr.engine, spec_descr.k_policy, spec_descr.deadline_sec, spec_descr.cancel_flag, spec_descr.tuning),
+                                      k_to_iterate,
+                                      model,
+                                      stats);
+    if (is_real && model != nullptr)
+        restore_signals(model, pruned);
+    return is_real;
+}
+
+
+spot::twa_graph_ptr sdf::translate_to_ucw(const spot::formula& formula,
+                                          TranslationLevel level)
+{
+    spot::formula neg_formula = spot::formula::Not(formula);
     spot::translator translator;
     translator.set_type(spot::postprocessor::BA);
     translator.set_pref(spot::postprocessor::SBAcc);
-    translator.set_level(spot::postprocessor::Medium);
+    translator.set_level(level == TranslationLevel::low ? spot::postprocessor::Low :
+                         level == TranslationLevel::high ? spot::postprocessor::High :
+                                                           spot::postprocessor::Medium);
     // On some examples the high optimization is the bottleneck
     // while Medium seems to be good enough. Eamples: try_ack_arbiter, lift
-    // The results of SYNTCOMP'21 confirm that Medium performs better by a noticeable margin, so we use Medium.
+    // The results of SYNTCOMP'21 confirm that Medium performs better by a noticeable margin, so Medium is the default.
 
     Timer timer;
     spot::twa_graph_ptr aut = translator.run(neg_formula);
@@ -212,7 +590,18 @@ bool sdf::synthesize_formula(const SpecDescr2<spot::formula>& spec_descr,
         spdlog::debug("\n{}", ss.str());
     }
 
-    return synthesize_atm(SpecDescr2(aut, spec_descr.inputs, spec_descr.outputs, spec_descr.is_moore, spec_descr.extract_model, spec_descr.do_reach_optim),
+    return aut;
+}
+
+
+bool sdf::synthesize_formula(const SpecDescr2<spot::formula>& spec_descr,
+                             const std::vector<uint>& k_to_iterate,
+                             aiger*& model,
+                             SynthStats* stats)
+{
+    auto aut = translate_to_ucw(spec_descr.spec, spec_descr.tuning.translation_level);
+    return synthesize_atm(SpecDescr2(aut, spec_descr.inputs, spec_descr.outputs, spec_descr.is_moore, spec_descr.extract_model, spec_descr.do_reach_optim, spec_descr.engine, spec_descr.k_policy, spec_descr.deadline_sec, spec_descr.cancel_flag, spec_descr.tuning),
                           k_to_iterate,
-                          model);
+                          model,
+                          stats);
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <unordered_map>
 #include <unordered_set>
 #include <spdlog/spdlog.h>
 
@@ -13,30 +15,70 @@ extern "C"
     #include <aiger.h>
 }
 
+#include "solver_tuning.hpp"
+
 
 namespace sdf
 {
 
-const uint R_OPTIM_BOUND = 120;  // reachability-analysis optimization is disabled when the number of states in the safety automaton exceeds this number
+const uint ANTICHAIN_BOUND = 2000;  // SolverEngine::automatic uses antichains when the estimated number of states in the safety automaton exceeds this number
+
+enum class SolverEngine
+{
+    symbolic,        // GameSolver: automaton states are encoded with BDD variables
+    counters,        // CounterGameSolver: as symbolic, but on the UCW with the visit counters in binary (no k-reduction)
+    explicit_state,  // ExplicitGameSolver: automaton states are explicit, only the moves are BDDs
+    local,           // LocalGameSolver: as explicit_state, but explores on-the-fly from the initial state
+    antichain,       // AntichainGameSolver: works on the UCW with counting functions (no k-reduction), prunes dominated nodes
+    automatic        // choose per k (see choose_engine in synthesizer.cpp)
+};
+
+enum class KBoundPolicy
+{
+    uniform,   // every SCC gets k
+    balanced,  // see balanced_k_by_scc in k_reduce.hpp
+    feedback   // start with the first k for every SCC, on failure raise the bounds of the SCCs exhausted in the losing plays,
+               // until the largest k (ceiling) or the deadline (SolverEngine::antichain only: automatic then means antichain)
+};
+
+/** the names of the engines and of the policies (as in the command line) */
+const std::unordered_map<std::string, SolverEngine>& get_engine_by_name();
+const std::unordered_map<std::string, KBoundPolicy>& get_k_policy_by_name();
+const std::unordered_map<std::string, ExtractMethod>& get_extract_method_by_name();
+const std::unordered_map<std::string, ExtractOrder>& get_extract_order_by_name();
+const std::unordered_map<std::string, ReorderPolicy>& get_reorder_policy_by_name();
+const std::unordered_map<std::string, TranslationLevel>& get_translation_level_by_name();
 
 struct SpecDescr
 {
     const bool check_unreal;
-    const std::string& file_name;
+    const std::string file_name;
     const bool extract_model;
     const bool do_reach_optim;
-    const std::string& output_file_name;
+    const std::string output_file_name;
+    const SolverEngine engine;
+    const KBoundPolicy k_policy;
+    const uint deadline_sec;  // no new k is tried after the deadline (0 means no deadline)
+    const SolverTuning tuning;
 
     SpecDescr(bool checkUnreal,
               const std::string& fileName,
               bool extractModel = false,
               bool do_reach_optim = false,
-              const std::string& outputFileName = "") :
+              const std::string& outputFileName = "",
+              SolverEngine engine = SolverEngine::symbolic,
+              KBoundPolicy k_policy = KBoundPolicy::uniform,
+              uint deadline_sec = 0,
+              const SolverTuning& tuning = SolverTuning()) :
             check_unreal(checkUnreal),
             file_name(fileName),
             extract_model(extractModel),
             do_reach_optim(do_reach_optim),
-            output_file_name(outputFileName) {}
+            output_file_name(outputFileName),
+            engine(engine),
+            k_policy(k_policy),
+            deadline_sec(deadline_sec),
+            tuning(tuning) {}
 };
 
 /**
@@ -64,27 +106,56 @@ struct SpecDescr2
     const bool is_moore;
     const bool extract_model;
     const bool do_reach_optim;
+    const SolverEngine engine;
+    const KBoundPolicy k_policy;
+    const uint deadline_sec;
+    const std::atomic<bool>* cancel_flag;  // no new k is tried and the BDD operations are aborted once it is set (nullptr: never)
+    const SolverTuning tuning;
 
     SpecDescr2(const T& spec,
               const std::unordered_set<spot::formula>& inputs,
               const std::unordered_set<spot::formula>& outputs,
               bool isMoore,
               bool extractModel,
-              bool do_reach_optim) :
+              bool do_reach_optim,
+              SolverEngine engine = SolverEngine::symbolic,
+              KBoundPolicy k_policy = KBoundPolicy::uniform,
+              uint deadline_sec = 0,
+              const std::atomic<bool>* cancel_flag = nullptr,
+              const SolverTuning& tuning = SolverTuning()) :
             spec(spec),
             inputs(inputs), outputs(outputs),
             is_moore(isMoore),
             extract_model(extractModel),
-            do_reach_optim(do_reach_optim) {}
+            do_reach_optim(do_reach_optim),
+            engine(engine),
+            k_policy(k_policy),
+            deadline_sec(deadline_sec),
+            cancel_flag(cancel_flag),
+            tuning(tuning) {}
+};
+
+struct SynthStats
+{
+    uint k = 0;          // the largest bound of the winning k_by_scc (0 if Adam wins for every tried bound)
+    uint nof_games = 0;  // the number of solved games (one per tried k_by_scc)
+    std::vector<std::string> memory_fallbacks;  // the cheaper paths taken under memory pressure (SolverTuning::memory_mb)
 };
 
+/**
+ * @return the UCW for the formula (the negated formula translated into a Buchi automaton)
+ */
+spot::twa_graph_ptr translate_to_ucw(const spot::formula& formula,
+                                     TranslationLevel level = TranslationLevel::medium);
+
 /**
  * Backwards-exploration synthesis algorithm.
  * @return true iff the formula is realizable
  */
 bool synthesize_formula(const SpecDescr2<spot::formula>& spec_descr,
                         const std::vector<uint>& k_to_iterate,
-                        aiger*& model);
+                        aiger*& model,
+                        SynthStats* stats = nullptr);
 
 /**
  * Backwards-exploration synthesis algorithm.
@@ -92,7 +163,8 @@ bool synthesize_formula(const SpecDescr2<spot::formula>& spec_descr,
  */
 bool synthesize_atm(const SpecDescr2<spot::twa_graph_ptr>& spec_descr,
                     const std::vector<uint>& k_to_iterate,
-                    aiger*& model);
+                    aiger*& model,
+                    SynthStats* stats = nullptr);
 
 
 } //namespace sdf
@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include <chrono>
 #include <ctime>
 
 namespace sdf
@@ -35,4 +36,36 @@ private:
     std::clock_t origin;
 };
 
+
+/**
+ * As Timer, but measures the wall-clock time rather than the CPU time of the process
+ * (which misses the time spent in child processes, blocking I/O, or waiting for a core):
+ * for the deadlines and the time budgets.
+ */
+class WallTimer
+{
+public:
+    WallTimer()
+    {
+        last = origin = std::chrono::steady_clock::now();
+    }
+
+    long sec_restart()
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last).count();
+        last = now;
+        return (long) elapsed;
+    }
+
+    long sec_from_origin() const
+    {
+        return (long) std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+    std::chrono::steady_clock::time_point origin;
+};
+
 }
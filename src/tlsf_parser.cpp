@@ -0,0 +1,1036 @@
+#include "tlsf_parser.hpp"
+#include "my_assert.hpp"
+#include "utils.hpp"
+
+#include <memory>
+#include <set>
+#include <optional>
+#include <algorithm>
+#include <cctype>
+
+
+using namespace std;
+using namespace sdf;
+
+
+#define hmap unordered_map
+
+
+namespace
+{
+
+/* ---------------------------------- lexer ---------------------------------- */
+
+enum class Tok { ident, number, string, symbol, end };
+
+struct Token
+{
+    Tok kind;
+    string text;
+    uint line;
+};
+
+
+// longest first
+const vector<string> SYMBOLS =  // NOLINT(cert-err58-cpp)
+    {"<->", "->", "<-", "||", "&&", "==", "!=", "<=", ">=",
+     "<", ">", "!", "+", "-", "*", "/", "%", "(", ")", "[", "]", "{", "}", ",", ";", ":", "="};
+
+
+vector<Token> tokenize(const string& text)
+{
+    vector<Token> tokens;
+    uint line = 1;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        if (c == '\n')
+        {
+            ++line;
+            ++i;
+            continue;
+        }
+        if (isspace(c))
+        {
+            ++i;
+            continue;
+        }
+        if (text.compare(i, 2, "//") == 0)
+        {
+            while (i < text.size() && text[i] != '\n')
+                ++i;
+            continue;
+        }
+        if (text.compare(i, 2, "/*") == 0)
+        {
+            auto end = text.find("*/", i+2);
+            MASSERT(end != string::npos, "TLSF: line " << line << ": unterminated comment");
+            line += count(text.begin() + (long)i, text.begin() + (long)end, '\n');
+            i = end + 2;
+            continue;
+        }
+        if (c == '"')
+        {
+            auto end = text.find('"', i+1);
+            MASSERT(end != string::npos, "TLSF: line " << line << ": unterminated string");
+            tokens.push_back({Tok::string, text.substr(i+1, end-i-1), line});
+            line += count(text.begin() + (long)i, text.begin() + (long)end, '\n');
+            i = end + 1;
+            continue;
+        }
+        if (isdigit(c))
+        {
+            auto start = i;
+            while (i < text.size() && isdigit(text[i]))
+                ++i;
+            tokens.push_back({Tok::number, text.substr(start, i-start), line});
+            continue;
+        }
+        if (isalpha(c) || c == '_' || c == '@')
+        {
+            auto start = i;
+            while (i < text.size() && (isalnum(text[i]) || text[i] == '_' || text[i] == '@' || text[i] == '\''))
+                ++i;
+            tokens.push_back({Tok::ident, text.substr(start, i-start), line});
+            continue;
+        }
+        auto sym = find_if(SYMBOLS.begin(), SYMBOLS.end(),
+                           [&](const string& s) { return text.compare(i, s.size(), s) == 0; });
+        MASSERT(sym != SYMBOLS.end(), "TLSF: line " << line << ": unexpected character: " << c);
+        tokens.push_back({Tok::symbol, *sym, line});
+        i += sym->size();
+    }
+    tokens.push_back({Tok::end, "", line});
+    return tokens;
+}
+
+
+/* ----------------------------------- AST ----------------------------------- */
+
+struct Expr;
+using ExprPtr = shared_ptr<const Expr>;
+
+/** `lower <(=) var <(=) upper` or `var IN set` */
+struct Binding
+{
+    string var;
+    ExprPtr lower, upper;       // (range)
+    bool lower_strict = false;
+    bool upper_strict = false;
+    ExprPtr set;                // (set)
+};
+
+struct Expr
+{
+    enum class Kind
+    {
+        number,     // `value`
+        boolean,    // `value`
+        ident,      // `name`
+        call,       // `name`(args)
+        index,      // args[0][args[1]]
+        set,        // {args}
+        unary,      // `op` args[0]: !, -, X, G, F, SIZEOF, MIN, MAX
+        binary,     // args[0] `op` args[1]
+        next_n,     // X[args[0]] args[1]
+        bounded,    // `op`[args[0] : args[1]] args[2]: G, F
+        big_op,     // `op`[bindings] args[0]: &&, ||, +, *
+        cases       // args[0] : args[1]  args[2] : args[3] ...
+    };
+
+    Kind kind;
+    uint line;
+    string op;  // (also the name)
+    long value = 0;
+    vector<ExprPtr> args;
+    vector<Binding> bindings;
+};
+
+
+ExprPtr make_expr(Expr::Kind kind, uint line, const string& op, vector<ExprPtr> args = {})
+{
+    auto e = make_shared<Expr>();
+    e->kind = kind;
+    e->line = line;
+    e->op = op;
+    e->args = move(args);
+    return e;
+}
+
+
+struct Definition
+{
+    vector<string> params;
+    ExprPtr body;
+};
+
+
+struct SignalDecl
+{
+    string name;
+    ExprPtr size;  // nullptr if it is not a bus
+};
+
+
+/* ---------------------------------- parser --------------------------------- */
+
+class Parser
+{
+public:
+    explicit Parser(vector<Token> tokens_) : tokens(move(tokens_)) { }
+
+    string title, description;
+    vector<string> semantics;  // e.g. {"Mealy", "Strict"}
+    string target;
+    hmap<string, Definition> definitions;  // (includes the parameters)
+    vector<SignalDecl> inputs, outputs;
+    hmap<string, vector<ExprPtr>> sections;  // INITIALLY, PRESET, REQUIRE, ASSERT, ASSUME, GUARANTEE
+
+    void parse_spec()
+    {
+        while (peek().kind != Tok::end)
+        {
+            auto name = expect_ident();
+            expect("{");
+            if (name == "INFO")
+                parse_info();
+            else if (name == "GLOBAL")
+                parse_global();
+            else if (name == "MAIN")
+                parse_main();
+            else
+                error("unknown section: " + name);
+            expect("}");
+        }
+    }
+
+private:
+    vector<Token> tokens;
+    size_t pos = 0;
+
+    const Token& peek(size_t offset = 0) const { return tokens[min(pos + offset, tokens.size() - 1)]; }
+
+    bool is(const string& text, size_t offset = 0) const
+    {
+        const auto& t = peek(offset);
+        return (t.kind == Tok::symbol || t.kind == Tok::ident) && t.text == text;
+    }
+
+    bool accept(const string& text)
+    {
+        if (!is(text))
+            return false;
+        ++pos;
+        return true;
+    }
+
+    [[noreturn]] void error(const string& message) const
+    {
+        MASSERT(0, "TLSF: line " << peek().line << ": " << message << " (near '" << peek().text << "')");
+        UNREACHABLE();
+    }
+
+    void expect(const string& text)
+    {
+        if (!accept(text))
+            error("expected '" + text + "'");
+    }
+
+    string expect_ident()
+    {
+        if (peek().kind != Tok::ident)
+            error("expected an identifier");
+        return tokens[pos++].text;
+    }
+
+    string expect_string()
+    {
+        if (peek().kind != Tok::string)
+            error("expected a string");
+        return tokens[pos++].text;
+    }
+
+    /* sections */
+
+    void parse_info()
+    {
+        while (!is("}"))
+        {
+            auto key = expect_ident();
+            expect(":");
+            if (key == "TITLE")
+                title = expect_string();
+            else if (key == "DESCRIPTION")
+                description = expect_string();
+            else if (key == "SEMANTICS")
+            {
+                semantics = {expect_ident()};
+                while (accept(","))
+                    semantics.push_back(expect_ident());
+            }
+            else if (key == "TARGET")
+                target = expect_ident();
+            else if (key == "TAGS")
+            {
+                if (peek().kind == Tok::string)
+                {
+                    expect_string();
+                    while (accept(","))
+                        expect_string();
+                }
+            }
+            else
+                error("unknown INFO field: " + key);
+        }
+    }
+
+    void parse_global()
+    {
+        while (!is("}"))
+        {
+            auto name = expect_ident();
+            expect("{");
+            if (name == "PARAMETERS")
+                while (!is("}"))
+                {
+                    auto param = expect_ident();
+                    expect("=");
+                    definitions[param] = {{}, parse_expr()};
+                    expect(";");
+                }
+            else if (name == "DEFINITIONS")
+                while (!is("}"))
+                    parse_definition();
+            else
+                error("unknown GLOBAL subsection: " + name);
+            expect("}");
+        }
+    }
+
+    void parse_definition()
+    {
+        if (is("enum"))
+            error("enumerations are not supported");
+
+        auto name = expect_ident();
+        Definition def;
+        if (accept("("))
+        {
+            def.params.push_back(expect_ident());
+            while (accept(","))
+                def.params.push_back(expect_ident());
+            expect(")");
+        }
+        expect("=");
+
+        auto line = peek().line;
+        auto first = parse_expr();
+        if (accept(":"))
+        {   // guard : value  guard : value ...
+            vector<ExprPtr> cases = {first, parse_expr()};
+            while (!is(";"))
+            {
+                cases.push_back(parse_expr());
+                expect(":");
+                cases.push_back(parse_expr());
+            }
+            def.body = make_expr(Expr::Kind::cases, line, "", cases);
+        }
+        else
+            def.body = first;
+        expect(";");
+
+        MASSERT(!definitions.count(name), "TLSF: line " << line << ": redefinition of " << name);
+        definitions[name] = def;
+    }
+
+    void parse_main()
+    {
+        const hmap<string, string> section_by_name =
+            {{"INITIALLY", "INITIALLY"}, {"PRESET", "PRESET"},
+             {"REQUIRE", "REQUIRE"}, {"REQUIREMENTS", "REQUIRE"},
+             {"ASSERT", "ASSERT"}, {"ASSERTIONS", "ASSERT"}, {"INVARIANTS", "ASSERT"},
+             {"ASSUME", "ASSUME"}, {"ASSUMPTIONS", "ASSUME"},
+             {"GUARANTEE", "GUARANTEE"}, {"GUARANTEES", "GUARANTEE"}};
+
+        while (!is("}"))
+        {
+            auto name = expect_ident();
+            expect("{");
+            if (name == "INPUTS" || name == "OUTPUTS")
+            {
+                auto& signals = (name == "INPUTS") ? inputs : outputs;
+                while (!is("}"))
+                {
+                    SignalDecl decl{expect_ident(), nullptr};
+                    if (accept("["))
+                    {
+                        decl.size = parse_expr();
+                        expect("]");
+                    }
+                    expect(";");
+                    signals.push_back(decl);
+                }
+            }
+            else if (section_by_name.count(name))
+            {
+                auto& section = sections[section_by_name.at(name)];
+                while (!is("}"))
+                {
+                    section.push_back(parse_expr());
+                    expect(";");
+                }
+            }
+            else
+                error("unknown MAIN subsection: " + name);
+            expect("}");
+        }
+    }
+
+    /* expressions (from the lowest precedence to the highest) */
+
+    ExprPtr binary(const string& op, const ExprPtr& l, const ExprPtr& r)
+    {
+        return make_expr(Expr::Kind::binary, l->line, op, {l, r});
+    }
+
+public:
+    ExprPtr parse_expr()
+    {
+        return parse_equiv();
+    }
+
+private:
+    ExprPtr parse_equiv()
+    {
+        auto l = parse_implies();
+        while (accept("<->"))
+            l = binary("<->", l, parse_implies());
+        return l;
+    }
+
+    ExprPtr parse_implies()
+    {
+        auto l = parse_or();
+        if (accept("->"))
+            return binary("->", l, parse_implies());  // (right associative)
+        return l;
+    }
+
+    ExprPtr parse_or()
+    {
+        auto l = parse_and();
+        while (accept("||"))
+            l = binary("||", l, parse_and());
+        return l;
+    }
+
+    ExprPtr parse_and()
+    {
+        auto l = parse_temporal();
+        while (accept("&&"))
+            l = binary("&&", l, parse_temporal());
+        return l;
+    }
+
+    ExprPtr parse_temporal()
+    {
+        auto l = parse_comparison();
+        for (const auto& op: {"U", "R", "W"})
+            if (accept(op))
+                return binary(op, l, parse_temporal());  // (right associative)
+        return l;
+    }
+
+    ExprPtr parse_comparison()
+    {
+        auto l = parse_set_op();
+        for (const auto& op: {"==", "!=", "<=", ">=", "<", ">", "IN"})
+            if (accept(op))
+                return binary(op, l, parse_set_op());
+        return l;
+    }
+
+    ExprPtr parse_set_op()
+    {
+        auto l = parse_additive();
+        while (is("CUP") || is("CAP") || is("SETMINUS"))
+        {
+            auto op = tokens[pos++].text;
+            l = binary(op, l, parse_additive());
+        }
+        return l;
+    }
+
+    ExprPtr parse_additive()
+    {
+        auto l = parse_multiplicative();
+        while (is("+") || is("-"))
+        {
+            auto op = tokens[pos++].text;
+            l = binary(op, l, parse_multiplicative());
+        }
+        return l;
+    }
+
+    ExprPtr parse_multiplicative()
+    {
+        auto l = parse_unary();
+        while (is("*") || is("/") || is("%"))
+        {
+            auto op = tokens[pos++].text;
+            l = binary(op, l, parse_unary());
+        }
+        return l;
+    }
+
+    ExprPtr parse_unary()
+    {
+        auto line = peek().line;
+
+        if (is("&&", 0) || is("||", 0) || is("+", 0) || is("*", 0))
+        {   // big operator: op[bindings] body
+            if (!is("[", 1))
+                error("expected '[' after the big operator");
+            auto op = tokens[pos++].text;
+            expect("[");
+            vector<Binding> bindings = {parse_binding()};
+            while (accept(","))
+                bindings.push_back(parse_binding());
+            expect("]");
+            auto e = make_shared<Expr>(*make_expr(Expr::Kind::big_op, line, op, {parse_unary()}));
+            e->bindings = bindings;
+            return e;
+        }
+
+        if (accept("!"))
+            return make_expr(Expr::Kind::unary, line, "!", {parse_unary()});
+        if (accept("-"))
+            return make_expr(Expr::Kind::unary, line, "-", {parse_unary()});
+
+        if (is("X") && is("[", 1))
+        {
+            pos += 2;
+            auto n = parse_expr();
+            expect("]");
+            return make_expr(Expr::Kind::next_n, line, "X", {n, parse_unary()});
+        }
+        if ((is("G") || is("F")) && is("[", 1))
+        {
+            auto op = tokens[pos].text;
+            pos += 2;
+            auto from = parse_expr();
+            expect(":");
+            auto to = parse_expr();
+            expect("]");
+            return make_expr(Expr::Kind::bounded, line, op, {from, to, parse_unary()});
+        }
+        for (const auto& op: {"X", "G", "F", "SIZEOF", "MIN", "MAX"})
+            if (accept(op))
+                return make_expr(Expr::Kind::unary, line, op, {parse_unary()});
+
+        return parse_postfix();
+    }
+
+    Binding parse_binding()
+    {
+        Binding b;
+        if (peek().kind == Tok::ident && (is("IN", 1) || is("<-", 1)))
+        {
+            b.var = expect_ident();
+            ++pos;
+            b.set = parse_additive();
+            return b;
+        }
+        b.lower = parse_additive();
+        if (!accept("<="))
+        {
+            expect("<");
+            b.lower_strict = true;
+        }
+        b.var = expect_ident();
+        if (!accept("<="))
+        {
+            expect("<");
+            b.upper_strict = true;
+        }
+        b.upper = parse_additive();
+        return b;
+    }
+
+    ExprPtr parse_postfix()
+    {
+        auto e = parse_primary();
+        while (is("["))
+        {
+            ++pos;
+            e = make_expr(Expr::Kind::index, e->line, "", {e, parse_expr()});
+            expect("]");
+        }
+        return e;
+    }
+
+    ExprPtr parse_primary()
+    {
+        const auto& t = peek();
+        auto line = t.line;
+
+        if (t.kind == Tok::number)
+        {
+            auto e = make_shared<Expr>(*make_expr(Expr::Kind::number, line, ""));
+            e->value = stol(tokens[pos++].text);
+            return e;
+        }
+        if (accept("true") || accept("otherwise"))
+        {
+            auto e = make_shared<Expr>(*make_expr(Expr::Kind::boolean, line, ""));
+            e->value = 1;
+            return e;
+        }
+        if (accept("false"))
+            return make_expr(Expr::Kind::boolean, line, "");
+        if (accept("("))
+        {
+            auto e = parse_expr();
+            expect(")");
+            return e;
+        }
+        if (accept("{"))
+        {
+            vector<ExprPtr> elements;
+            if (!is("}"))
+            {
+                elements.push_back(parse_expr());
+                while (accept(","))
+                    elements.push_back(parse_expr());
+            }
+            expect("}");
+            return make_expr(Expr::Kind::set, line, "", elements);
+        }
+        if (t.kind == Tok::ident)
+        {
+            auto name = expect_ident();
+            if (!accept("("))
+                return make_expr(Expr::Kind::ident, line, name);
+            vector<ExprPtr> args;
+            if (!is(")"))
+            {
+                args.push_back(parse_expr());
+                while (accept(","))
+                    args.push_back(parse_expr());
+            }
+            expect(")");
+            return make_expr(Expr::Kind::call, line, name, args);
+        }
+        error("unexpected token");
+    }
+};
+
+
+/* -------------------------------- evaluator -------------------------------- */
+
+struct Value
+{
+    enum class Kind { number, formula, bus, set };
+
+    Kind kind = Kind::number;
+    long number = 0;
+    spot::formula formula;
+    vector<spot::formula> bus;
+    std::set<long> elements;
+
+    static Value of_number(long n) { Value v; v.number = n; return v; }
+    static Value of_formula(const spot::formula& f) { Value v; v.kind = Kind::formula; v.formula = f; return v; }
+    static Value of_bool(bool b) { return of_formula(b ? spot::formula::tt() : spot::formula::ff()); }
+};
+
+
+class Evaluator
+{
+public:
+    Evaluator(const hmap<string, Definition>& definitions_,
+              const hmap<string, Value>& signals_) :
+        definitions(definitions_), signals(signals_)
+    { }
+
+    using Scope = hmap<string, Value>;
+
+    Value eval(const Expr& e, const Scope& scope)
+    {
+        switch (e.kind)
+        {
+            case Expr::Kind::number:
+                return Value::of_number(e.value);
+
+            case Expr::Kind::boolean:
+                return Value::of_bool(e.value != 0);
+
+            case Expr::Kind::ident:
+            {
+                if (auto it = scope.find(e.op); it != scope.end())
+                    return it->second;
+                if (auto it = signals.find(e.op); it != signals.end())
+                    return it->second;
+                return call(e, e.op, {});
+            }
+
+            case Expr::Kind::call:
+            {
+                vector<Value> args;
+                for (const auto& a: e.args)
+                    args.push_back(eval(*a, scope));
+                return call(e, e.op, args);
+            }
+
+            case Expr::Kind::index:
+            {
+                auto bus = eval(*e.args[0], scope);
+                check(e, bus.kind == Value::Kind::bus, "indexing a non-bus");
+                auto i = get_number(e, *e.args[1], scope);
+                check(e, 0 <= i && i < (long)bus.bus.size(), "bus index out of range: " + to_string(i));
+                return Value::of_formula(bus.bus[i]);
+            }
+
+            case Expr::Kind::set:
+            {
+                Value v;
+                v.kind = Value::Kind::set;
+                for (const auto& a: e.args)
+                    v.elements.insert(get_number(e, *a, scope));
+                return v;
+            }
+
+            case Expr::Kind::unary:
+                return eval_unary(e, scope);
+
+            case Expr::Kind::binary:
+                return eval_binary(e, scope);
+
+            case Expr::Kind::next_n:
+            {
+                auto n = get_number(e, *e.args[0], scope);
+                check(e, n >= 0, "negative X[n]");
+                return Value::of_formula(next(get_formula(e, *e.args[1], scope), n));
+            }
+
+            case Expr::Kind::bounded:
+            {   // G[a:b] f = X^a f && ... && X^b f, F[a:b] f = X^a f || ... || X^b f
+                auto from = get_number(e, *e.args[0], scope);
+                auto to = get_number(e, *e.args[1], scope);
+                check(e, 0 <= from, "negative bound");
+                auto f = get_formula(e, *e.args[2], scope);
+                vector<spot::formula> operands;
+                for (auto i = from; i <= to; ++i)
+                    operands.push_back(next(f, i));
+                return Value::of_formula(e.op == "G" ? spot::formula::And(operands) : spot::formula::Or(operands));
+            }
+
+            case Expr::Kind::big_op:
+            {
+                vector<Value> values;
+                Scope inner = scope;
+                enumerate(e, 0, inner, values);
+                if (e.op == "&&" || e.op == "||")
+                {
+                    vector<spot::formula> operands;
+                    for (const auto& v: values)
+                        operands.push_back(as_formula(e, v));
+                    return Value::of_formula(e.op == "&&" ? spot::formula::And(operands) : spot::formula::Or(operands));
+                }
+                long result = (e.op == "+") ? 0 : 1;
+                for (const auto& v: values)
+                    result = (e.op == "+") ? result + as_number(e, v) : result * as_number(e, v);
+                return Value::of_number(result);
+            }
+
+            case Expr::Kind::cases:
+            {
+                for (size_t i = 0; i < e.args.size(); i += 2)
+                {
+                    auto guard = get_formula(e, *e.args[i], scope);
+                    check(e, guard.is_tt() || guard.is_ff(), "the guard does not evaluate to true or false");
+                    if (guard.is_tt())
+                        return eval(*e.args[i+1], scope);
+                }
+                error(e, "none of the guards holds");
+            }
+        }
+        UNREACHABLE();
+    }
+
+    spot::formula get_formula(const Expr& parent, const Expr& e, const Scope& scope)
+    {
+        return as_formula(parent, eval(e, scope));
+    }
+
+    long get_number(const Expr& parent, const Expr& e, const Scope& scope)
+    {
+        return as_number(parent, eval(e, scope));
+    }
+
+    [[noreturn]] static void error(const Expr& e, const string& message)
+    {
+        MASSERT(0, "TLSF: line " << e.line << ": " << message);
+        UNREACHABLE();
+    }
+
+private:
+    const hmap<string, Definition>& definitions;
+    const hmap<string, Value>& signals;
+
+    static void check(const Expr& e, bool condition, const string& message)
+    {
+        if (!condition)
+            error(e, message);
+    }
+
+    static spot::formula as_formula(const Expr& e, const Value& v)
+    {
+        check(e, v.kind == Value::Kind::formula, "expected a formula");
+        return v.formula;
+    }
+
+    static long as_number(const Expr& e, const Value& v)
+    {
+        check(e, v.kind == Value::Kind::number, "expected a number");
+        return v.number;
+    }
+
+    static spot::formula next(spot::formula f, long n)
+    {
+        for (long i = 0; i < n; ++i)
+            f = spot::formula::X(f);
+        return f;
+    }
+
+    // (the division and the modulo round towards minus infinity, as in syfco)
+    static long floor_div(long a, long b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+    static long floor_mod(long a, long b) { return a - b * floor_div(a, b); }
+
+    Value call(const Expr& e, const string& name, const vector<Value>& args)
+    {
+        auto it = definitions.find(name);
+        check(e, it != definitions.end(), "unknown identifier: " + name);
+        const auto& def = it->second;
+        check(e, def.params.size() == args.size(),
+              name + " expects " + to_string(def.params.size()) + " arguments, but got " + to_string(args.size()));
+        Scope scope;  // (definitions see only their parameters and the global names)
+        for (size_t i = 0; i < args.size(); ++i)
+            scope[def.params[i]] = args[i];
+        return eval(*def.body, scope);
+    }
+
+    void enumerate(const Expr& e, size_t binding_idx, Scope& scope, vector<Value>& values)
+    {
+        if (binding_idx == e.bindings.size())
+        {
+            values.push_back(eval(*e.args[0], scope));
+            return;
+        }
+
+        const auto& b = e.bindings[binding_idx];
+        vector<long> range;
+        if (b.set)
+        {
+            auto set = eval(*b.set, scope);
+            check(e, set.kind == Value::Kind::set, "expected a set");
+            range.assign(set.elements.begin(), set.elements.end());
+        }
+        else
+        {
+            auto from = get_number(e, *b.lower, scope) + b.lower_strict;
+            auto to = get_number(e, *b.upper, scope) - b.upper_strict;
+            for (auto i = from; i <= to; ++i)
+                range.push_back(i);
+        }
+
+        auto saved = scope.count(b.var) ? optional<Value>(scope.at(b.var)) : nullopt;
+        for (auto i: range)
+        {
+            scope[b.var] = Value::of_number(i);
+            enumerate(e, binding_idx + 1, scope, values);
+        }
+        if (saved)
+            scope[b.var] = *saved;
+        else
+            scope.erase(b.var);
+    }
+
+    Value eval_unary(const Expr& e, const Scope& scope)
+    {
+        if (e.op == "-")
+            return Value::of_number(-get_number(e, *e.args[0], scope));
+
+        if (e.op == "SIZEOF" || e.op == "MIN" || e.op == "MAX")
+        {
+            auto v = eval(*e.args[0], scope);
+            if (e.op == "SIZEOF")
+            {
+                check(e, v.kind == Value::Kind::bus || v.kind == Value::Kind::set, "SIZEOF expects a bus or a set");
+                return Value::of_number(v.kind == Value::Kind::bus ? (long)v.bus.size() : (long)v.elements.size());
+            }
+            check(e, v.kind == Value::Kind::set && !v.elements.empty(), e.op + " expects a non-empty set");
+            return Value::of_number(e.op == "MIN" ? *v.elements.begin() : *v.elements.rbegin());
+        }
+
+        auto f = get_formula(e, *e.args[0], scope);
+        if (e.op == "!")
+            return Value::of_formula(spot::formula::Not(f));
+        if (e.op == "X")
+            return Value::of_formula(spot::formula::X(f));
+        if (e.op == "G")
+            return Value::of_formula(spot::formula::G(f));
+        if (e.op == "F")
+            return Value::of_formula(spot::formula::F(f));
+        UNREACHABLE();
+    }
+
+    Value eval_binary(const Expr& e, const Scope& scope)
+    {
+        auto l = eval(*e.args[0], scope);
+        auto r = eval(*e.args[1], scope);
+        const auto& op = e.op;
+
+        if (op == "&&" || op == "||" || op == "->" || op == "<->" || op == "U" || op == "R" || op == "W")
+        {
+            auto fl = as_formula(e, l), fr = as_formula(e, r);
+            if (op == "&&") return Value::of_formula(spot::formula::And({fl, fr}));
+            if (op == "||") return Value::of_formula(spot::formula::Or({fl, fr}));
+            if (op == "->") return Value::of_formula(spot::formula::Implies(fl, fr));
+            if (op == "<->") return Value::of_formula(spot::formula::Equiv(fl, fr));
+            if (op == "U") return Value::of_formula(spot::formula::U(fl, fr));
+            if (op == "R") return Value::of_formula(spot::formula::R(fl, fr));
+            return Value::of_formula(spot::formula::W(fl, fr));
+        }
+
+        if (op == "IN")
+        {
+            check(e, r.kind == Value::Kind::set, "IN expects a set");
+            return Value::of_bool(r.elements.count(as_number(e, l)) > 0);
+        }
+
+        if (op == "CUP" || op == "CAP" || op == "SETMINUS")
+        {
+            check(e, l.kind == Value::Kind::set && r.kind == Value::Kind::set, op + " expects sets");
+            Value v;
+            v.kind = Value::Kind::set;
+            auto out = inserter(v.elements, v.elements.begin());
+            if (op == "CUP")
+                set_union(l.elements.begin(), l.elements.end(), r.elements.begin(), r.elements.end(), out);
+            else if (op == "CAP")
+                set_intersection(l.elements.begin(), l.elements.end(), r.elements.begin(), r.elements.end(), out);
+            else
+                set_difference(l.elements.begin(), l.elements.end(), r.elements.begin(), r.elements.end(), out);
+            return v;
+        }
+
+        if ((op == "==" || op == "!=") && l.kind == Value::Kind::formula)
+            return Value::of_bool((as_formula(e, l) == as_formula(e, r)) == (op == "=="));
+
+        auto a = as_number(e, l), b = as_number(e, r);
+        if (op == "+") return Value::of_number(a + b);
+        if (op == "-") return Value::of_number(a - b);
+        if (op == "*") return Value::of_number(a * b);
+        if (op == "/" || op == "%")
+        {
+            check(e, b != 0, "division by zero");
+            return Value::of_number(op == "/" ? floor_div(a, b) : floor_mod(a, b));
+        }
+        if (op == "==") return Value::of_bool(a == b);
+        if (op == "!=") return Value::of_bool(a != b);
+        if (op == "<") return Value::of_bool(a < b);
+        if (op == "<=") return Value::of_bool(a <= b);
+        if (op == ">") return Value::of_bool(a > b);
+        if (op == ">=") return Value::of_bool(a >= b);
+        UNREACHABLE();
+    }
+};
+
+}  // namespace
+
+
+TlsfSpec sdf::parse_tlsf_text(const string& text,
+                              const hmap<string, int>& param_overrides)
+{
+    Parser parser(tokenize(text));
+    parser.parse_spec();
+
+    for (const auto& [param, value]: param_overrides)
+    {
+        MASSERT(parser.definitions.count(param) && parser.definitions.at(param).params.empty(),
+                "TLSF: unknown parameter: " << param);
+        auto e = make_shared<Expr>();
+        e->kind = Expr::Kind::number;
+        e->value = value;
+        parser.definitions[param].body = e;
+    }
+
+    TlsfSpec spec;
+    spec.title = parser.title;
+    spec.description = parser.description;
+
+    for (const auto& s: parser.semantics)
+        if (s == "Strict")
+            spec.is_strict = true;
+        else if (s == "Moore")
+            spec.is_moore_semantics = true;
+        else
+            MASSERT(s == "Mealy", "TLSF: unsupported semantics: " << s);
+    MASSERT(parser.target == "Mealy" || parser.target == "Moore", "TLSF: unknown target: " << parser.target);
+    spec.is_moore_target = parser.target == "Moore";
+
+    // signals (the bus r[2] becomes r_0, r_1, as with syfco's default bus delimiter)
+    hmap<string, Value> signals;
+    Evaluator size_evaluator(parser.definitions, signals);  // (sizes cannot refer to signals)
+    auto declare = [&](const vector<SignalDecl>& decls, vector<string>& names)
+    {
+        for (const auto& decl: decls)
+        {
+            MASSERT(!signals.count(decl.name), "TLSF: the signal is declared twice: " << decl.name);
+            if (!decl.size)
+            {
+                names.push_back(decl.name);
+                signals[decl.name] = Value::of_formula(spot::formula::ap(decl.name));
+                continue;
+            }
+            auto size = size_evaluator.get_number(*decl.size, *decl.size, {});
+            MASSERT(size >= 0, "TLSF: negative size of the bus " << decl.name);
+            Value bus;
+            bus.kind = Value::Kind::bus;
+            for (long i = 0; i < size; ++i)
+            {
+                names.push_back(decl.name + "_" + to_string(i));
+                bus.bus.push_back(spot::formula::ap(names.back()));
+            }
+            signals[decl.name] = bus;
+        }
+    };
+    declare(parser.inputs, spec.inputs);
+    declare(parser.outputs, spec.outputs);
+
+    Evaluator evaluator(parser.definitions, signals);
+    auto conjunction = [&](const string& section)
+    {
+        vector<spot::formula> conjuncts;
+        if (parser.sections.count(section))
+            for (const auto& e: parser.sections.at(section))
+                conjuncts.push_back(evaluator.get_formula(*e, *e, {}));
+        return spot::formula::And(conjuncts);
+    };
+
+    auto initially = conjunction("INITIALLY");
+    auto preset = conjunction("PRESET");
+    auto require = conjunction("REQUIRE");
+    auto assert_ = conjunction("ASSERT");
+    auto assume = conjunction("ASSUME");
+    auto guarantee = conjunction("GUARANTEE");
+
+    using F = spot::formula;
+    auto env = F::And({F::G(require), assume});
+    spec.formula = spec.is_strict
+        ? F::Implies(initially, F::And({preset, F::W(assert_, F::Not(require)), F::Implies(env, guarantee)}))
+        : F::Implies(initially, F::And({preset, F::Implies(env, F::And({F::G(assert_), guarantee}))}));
+
+    return spec;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define BDD spotBDD
+    #include <spot/tl/formula.hh>
+#undef BDD
+
+
+namespace sdf
+{
+
+struct TlsfSpec
+{
+    std::string title;
+    std::string description;
+    bool is_strict = false;                // SEMANTICS: Mealy,Strict or Moore,Strict
+    bool is_moore_semantics = false;       // (does not affect the formula)
+    bool is_moore_target = false;          // TARGET
+    std::vector<std::string> inputs;       // (ordered as declared; bus r[2] becomes r_0, r_1)
+    std::vector<std::string> outputs;
+    spot::formula formula;
+};
+
+/**
+ * In-process TLSF front end (the basic and the parameterized subsets of TLSF 1.1, as used in SYNTCOMP).
+ * The formula is the same as `syfco -f ltl` produces, i.e., for the non-strict semantics:
+ *
+ *     INITIALLY -> (PRESET && ((G REQUIRE && ASSUME) -> (G ASSERT && GUARANTEE)))
+ *
+ * and for the strict semantics:
+ *
+ *     INITIALLY -> (PRESET && (ASSERT W !REQUIRE) && ((G REQUIRE && ASSUME) -> GUARANTEE))
+ *
+ * Not supported: enumerations, the finite semantics.
+ * @param param_overrides values of the parameters that override those in the spec (as syfco's -op)
+ */
+TlsfSpec parse_tlsf_text(const std::string& text,
+                         const std::unordered_map<std::string, int>& param_overrides = {});
+
+} //namespace sdf
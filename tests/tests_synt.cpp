@@ -1,13 +1,44 @@
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "cert-err58-cpp"
 
+#include <chrono>
 #include <string>
+#include <optional>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
+#include <fstream>
+#include <sstream>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BDD spotBDD
+    #include <spot/tl/parse.hh>
+    #include <spot/twaalgos/contains.hh>
+#undef BDD
 
 #include "gtest/gtest.h"
 #include "syntcomp_constants.hpp"
 #include "synthesizer.hpp"
+#include "batch.hpp"
+#include "bdd_io.hpp"
+#include "game_solver.hpp"
+#include "k_reduce.hpp"
+#include "ltl_parser.hpp"
+#include "cluster.hpp"
+#include "ehoa_parser.hpp"
+#include "portfolio.hpp"
+#include "reachability.hpp"
+#include "server.hpp"
+#include "signal_pruning.hpp"
+#include "synthesis_api.hpp"
+#include "tlsf_parser.hpp"
 #include "utils.hpp"
 
 
@@ -86,9 +117,580 @@ TEST_P(RealCheckFixture, check_real)
         ASSERT_EQ(SYNTCOMP_RC_UNKNOWN, status);
 }
 
+TEST_P(RealCheckFixture, check_real_balanced_k)
+{
+    // The symbolic engine k-reduces every SCC by its own bound, the antichain engine counts the visits with the same bounds:
+    // they must agree. The balanced bounds are at most k, so they can lose realizability but must never gain it,
+    // and they lose nothing when no bound is lowered.
+    auto spec = GetParam();
+    auto status = run_tlsf(SpecDescr(false, "./specs/" + spec.name, false, false, "", SolverEngine::symbolic, KBoundPolicy::balanced), {4});
+    if (!spec.is_real)
+    {
+        ASSERT_EQ(SYNTCOMP_RC_UNKNOWN, status);
+        return;
+    }
+    auto expected = run_tlsf(SpecDescr(false, "./specs/" + spec.name, false, false, "", SolverEngine::antichain, KBoundPolicy::balanced), {4});
+    ASSERT_EQ(expected, status);
+
+    spot::formula formula;
+    unordered_set<spot::formula> inputs, outputs;
+    bool is_moore;
+    tie(formula, inputs, outputs, is_moore) = parse_tlsf("./specs/" + spec.name);
+    auto k_by_scc = balanced_k_by_scc(translate_to_ucw(formula), 4);
+    if (all_of(k_by_scc.begin(), k_by_scc.end(), [](uint k) { return k == 0 || k == 4; }))
+    {
+        ASSERT_EQ(SYNTCOMP_RC_REAL, status);
+    }
+}
+
+TEST_P(RealCheckFixture, check_real_feedback_k)
+{
+    // starts with k=1 and raises the bounds of the exhausted SCCs up to 8 (the specs are realizable with k=4)
+    auto spec = GetParam();
+    auto status = run_tlsf(SpecDescr(false, "./specs/" + spec.name, false, false, "", SolverEngine::antichain, KBoundPolicy::feedback), {1, 8});
+    if (spec.is_real)
+        ASSERT_EQ(SYNTCOMP_RC_REAL, status);
+    else
+        ASSERT_EQ(SYNTCOMP_RC_UNKNOWN, status);
+}
+
 INSTANTIATE_TEST_SUITE_P(RealUnreal, RealCheckFixture, ::testing::ValuesIn(specs));
 
 
+/**
+  * Checking that the feedback policy is refused by the engines without the witness of the loss,
+  * and that the automatic engine then uses antichains
+**/
+TEST(FeedbackTest, needs_the_antichain_engine)
+{
+    for (auto engine: {SolverEngine::symbolic, SolverEngine::counters, SolverEngine::explicit_state, SolverEngine::local})
+        ASSERT_THROW(run_tlsf(SpecDescr(false, "./specs/full_arbiter.tlsf", false, false, "", engine, KBoundPolicy::feedback), {1, 8}),
+                     logic_error);
+    ASSERT_EQ(SYNTCOMP_RC_REAL,
+              run_tlsf(SpecDescr(false, "./specs/full_arbiter.tlsf", false, false, "", SolverEngine::automatic, KBoundPolicy::feedback), {1, 8}));
+}
+
+
+/**
+  * Checking the in-memory API
+**/
+class ApiFixture : public ::testing::TestWithParam<SpecParam> { };
+
+TEST_P(ApiFixture, synthesize_tlsf_text)
+{
+    auto spec = GetParam();
+    SynthOptions options;
+    options.extract_model = spec.is_real;
+    auto result = synthesize_tlsf_text(readfile("./specs/" + spec.name), options);
+    if (spec.is_real)
+    {
+        ASSERT_EQ(Verdict::realizable, result.verdict);
+        ASSERT_EQ(4u, result.k);
+        ASSERT_EQ(0u, result.model_as_aag().rfind("aag ", 0));
+    }
+    else
+    {
+        ASSERT_EQ(Verdict::unknown, result.verdict);
+        ASSERT_EQ(nullptr, result.model);
+    }
+}
+
+TEST_P(ApiFixture, cancelled)
+{
+    CancellationToken token;
+    token.cancel();
+    auto result = synthesize_tlsf_text(readfile("./specs/" + GetParam().name), SynthOptions(), &token);
+    ASSERT_EQ(Verdict::cancelled, result.verdict);
+    ASSERT_EQ(0u, result.nof_games);
+}
+
+INSTANTIATE_TEST_SUITE_P(Specs, ApiFixture, ::testing::ValuesIn(specs));
+
+class CancelFixture : public ::testing::TestWithParam<SolverEngine> { };
+
+TEST_P(CancelFixture, cancelled_while_solving)
+{
+    // Adam wins all these games, and they take far longer than the test waits: the solving must be aborted midway
+    SynthOptions options;
+    options.engine = GetParam();
+    options.k_to_iterate = {100, 200, 400, 800};
+    CancellationToken token;
+    thread canceller([&]() { this_thread::sleep_for(chrono::seconds(1)); token.cancel(); });
+    auto start = chrono::steady_clock::now();
+    auto result = synthesize_ehoa_text(readfile("./specs/hoa/full_arbiter_unreal1.ehoa"), options, &token);
+    auto sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    canceller.join();
+    ASSERT_EQ(Verdict::cancelled, result.verdict);
+    ASSERT_LE(1u, result.nof_games);
+    ASSERT_LT(sec, 30);
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, CancelFixture,
+                         ::testing::Values(SolverEngine::symbolic, SolverEngine::counters, SolverEngine::explicit_state,
+                                           SolverEngine::local, SolverEngine::antichain));
+
+
+/**
+  * Checking the result lines of the batch and cluster modes (up to the summary line, if any):
+  * one line per spec, with the verdict of the one-spec-per-process mode
+**/
+void check_verdict_lines(const string& lines)
+{
+    uint nof_lines = 0;
+    stringstream ss(lines);
+    for (string line; getline(ss, line) && line.find("\"summary\"") == string::npos; ++nof_lines)
+    {
+        auto spec = find_if(specs.begin(), specs.end(),
+                            [&](const SpecParam& s) { return line.find("\"./specs/" + s.name + "\"") != string::npos; });
+        ASSERT_NE(specs.end(), spec) << line;
+        auto expected = string("\"verdict\": \"") + (spec->is_real ? SYNTCOMP_STR_REAL : SYNTCOMP_STR_UNKNOWN) + "\"";
+        ASSERT_NE(string::npos, line.find(expected)) << line;
+    }
+    ASSERT_EQ(specs.size(), nof_lines);
+}
+
+
+/**
+  * Checking the batch mode: the verdicts are the same as in one-spec-per-process mode
+**/
+TEST(BatchTest, verdicts_of_all_specs)
+{
+    BatchDescr batch_descr;
+    for (const auto& spec: specs)
+        batch_descr.spec_files.push_back("./specs/" + spec.name);
+    batch_descr.nof_workers = 3;
+
+    testing::internal::CaptureStdout();
+    auto rc = run_batch(batch_descr);
+    auto lines = testing::internal::GetCapturedStdout();
+    ASSERT_EQ(0, rc);
+
+    ASSERT_NO_FATAL_FAILURE(check_verdict_lines(lines));
+}
+
+
+/**
+  * Checking the other engines: the same verdicts as the symbolic one
+**/
+const vector<SolverEngine> other_engines =
+{
+    SolverEngine::explicit_state,
+    SolverEngine::local,
+    SolverEngine::counters,
+    SolverEngine::antichain
+};
+
+class EngineRealCheckFixture : public ::testing::TestWithParam<tuple<SpecParam, SolverEngine>> { };
+
+TEST_P(EngineRealCheckFixture, check_real)
+{
+    auto [spec, engine] = GetParam();
+    auto status = run_tlsf(SpecDescr(false, "./specs/" + spec.name, false, false, "", engine), {4});
+    if (spec.is_real)
+        ASSERT_EQ(SYNTCOMP_RC_REAL, status);
+    else
+        ASSERT_EQ(SYNTCOMP_RC_UNKNOWN, status);
+}
+
+INSTANTIATE_TEST_SUITE_P(RealUnreal,
+                         EngineRealCheckFixture,
+                         ::testing::Combine(::testing::ValuesIn(specs), ::testing::ValuesIn(other_engines)));
+
+
+/**
+  * Checking the reachability: a 3-bit counter that counts up to 5 while the input is high
+**/
+TEST(ReachabilityTest, saturating_counter)
+{
+    Cudd cudd;
+    BDD i = cudd.bddVar(0);
+    vector<BDD> x = {cudd.bddVar(1), cudd.bddVar(2), cudd.bddVar(3)};  // (x[0] is the lowest bit)
+    auto value_is = [&](uint v) { return ((v & 1) ? x[0] : ~x[0]) & ((v & 2) ? x[1] : ~x[1]) & ((v & 4) ? x[2] : ~x[2]); };
+
+    auto inc = i & ~value_is(5);
+    unordered_map<uint, BDD> next_by_latch = {{1, x[0] ^ inc},
+                                              {2, x[1] ^ (inc & x[0])},
+                                              {3, x[2] ^ (inc & x[0] & x[1])}};
+    Reachability reachability(cudd, next_by_latch, {i});
+
+    auto expected = cudd.bddZero();
+    for (uint v = 0; v <= 5; ++v)
+        expected |= value_is(v);
+    ASSERT_TRUE(reachability.compute(value_is(0), cudd.bddOne()) == expected);
+    ASSERT_TRUE(reachability.compute(value_is(0), ~i) == value_is(0));
+}
+
+
+/**
+  * Checking the partitioned relation (the range computation gets no budget) against the monolithic relation,
+  * on a circuit whose latches depend on each other and on the inputs
+**/
+TEST(ReachabilityTest, clusters_as_monolithic)
+{
+    Cudd cudd;
+    vector<BDD> i = {cudd.bddVar(0), cudd.bddVar(1)};
+    vector<BDD> x = {cudd.bddVar(2), cudd.bddVar(3), cudd.bddVar(4), cudd.bddVar(5)};
+    vector<BDD> next = {i[0] ^ x[3],
+                        x[0] & ~i[1],
+                        x[1] | (x[0] & x[3]),
+                        x[2] ^ (x[1] & i[1])};
+    unordered_map<uint, BDD> next_by_latch;
+    for (uint j = 0; j < x.size(); ++j)
+        next_by_latch.emplace(2 + j, next[j]);
+    auto init = ~x[0] & ~x[1] & ~x[2] & ~x[3];
+
+    // the monolithic relation over the primed variables
+    vector<BDD> primed;
+    BDD relation = cudd.bddOne();
+    for (uint j = 0; j < x.size(); ++j)
+    {
+        primed.push_back(cudd.bddVar((int) (6 + j)));
+        relation &= primed[j].Xnor(next[j]);
+    }
+    auto cube = i[0] & i[1] & x[0] & x[1] & x[2] & x[3];
+    auto compute_monolithic = [&](const BDD& constraint)
+    {
+        BDD reach = init;
+        while (true)
+        {
+            BDD img = (reach & constraint).AndAbstract(relation, cube).SwapVariables(primed, x);
+            if ((img & ~reach).IsZero())
+                return reach;
+            reach |= img;
+        }
+    };
+
+    for (const auto& constraint: {cudd.bddOne(), ~(i[0] & i[1]) | x[2], ~i[0] & ~x[1]})
+    {
+        auto expected = compute_monolithic(constraint);
+        Reachability via_clusters(cudd, next_by_latch, i, 0);
+        ASSERT_TRUE(via_clusters.compute(init, constraint) == expected);
+        Reachability via_range(cudd, next_by_latch, i);
+        ASSERT_TRUE(via_range.compute(init, constraint) == expected);
+    }
+}
+
+TEST(BddIoTest, save_and_load)
+{
+    Cudd cudd;
+    vector<BDD> v;
+    for (uint i = 0; i < 4; ++i)
+    {
+        v.push_back(cudd.bddVar((int)i));
+        cudd.pushVariableName("v" + to_string(i));
+    }
+    BDD f = (v[0] & ~v[2]) | (v[1] ^ v[3]);
+    BDD g = ~f & v[2];
+
+    auto file_name = create_tmp_folder() + "/bdds";
+    save_bdds(cudd, {{"f", f}, {"g", g}, {"one", cudd.bddOne()}}, file_name);
+    auto bdd_by_name = load_bdds(cudd, file_name);
+    ASSERT_TRUE(bdd_by_name.has_value());
+    ASSERT_TRUE(bdd_by_name->at("f") == f);
+    ASSERT_TRUE(bdd_by_name->at("g") == g);
+    ASSERT_TRUE(bdd_by_name->at("one").IsOne());
+
+    Cudd other;
+    for (uint i = 0; i < 4; ++i)
+    {
+        other.bddVar((int)i);
+        other.pushVariableName("w" + to_string(i));
+    }
+    ASSERT_FALSE(load_bdds(other, file_name).has_value());
+}
+
+TEST(BddIoTest, load_into_fresh_manager)
+{
+    Cudd cudd;
+    vector<BDD> v;
+    for (uint i = 0; i < 4; ++i)
+    {
+        v.push_back(cudd.bddVar((int)i));
+        cudd.pushVariableName("v" + to_string(i));
+    }
+    vector<int> saved_order = {2, 0, 3, 1};
+    cudd.ShuffleHeap(saved_order.data());
+    BDD f = (v[0] & ~v[2]) | (v[1] ^ v[3]);
+
+    auto file_name = create_tmp_folder() + "/bdds";
+    save_bdds(cudd, {{"f", f}}, file_name);
+
+    // the same variables in another order: the saved order is restored
+    Cudd fresh;
+    vector<BDD> w;
+    for (uint i = 0; i < 4; ++i)
+    {
+        w.push_back(fresh.bddVar((int)i));
+        fresh.pushVariableName("v" + to_string(i));
+    }
+    vector<int> other_order = {3, 1, 0, 2};
+    fresh.ShuffleHeap(other_order.data());
+
+    auto bdd_by_name = load_bdds(fresh, file_name);
+    ASSERT_TRUE(bdd_by_name.has_value());
+    for (int i = 0; i < 4; ++i)
+        ASSERT_EQ(cudd.ReadPerm(i), fresh.ReadPerm(i)) << "variable " << i;
+    ASSERT_TRUE(bdd_by_name->at("f") == ((w[0] & ~w[2]) | (w[1] ^ w[3])));
+}
+
+TEST(BddIoTest, load_some_without_reordering)
+{
+    Cudd cudd;
+    vector<BDD> v;
+    for (uint i = 0; i < 4; ++i)
+    {
+        v.push_back(cudd.bddVar((int)i));
+        cudd.pushVariableName("v" + to_string(i));
+    }
+    vector<int> saved_order = {2, 0, 3, 1};
+    cudd.ShuffleHeap(saved_order.data());
+    BDD f = (v[0] & ~v[2]) | (v[1] ^ v[3]);
+    BDD g = v[1] & v[3];
+
+    auto file_name = create_tmp_folder() + "/bdds";
+    save_bdds(cudd, {{"f", f}, {"g", g}}, file_name);
+
+    // only g is built, and the order of `fresh` is kept
+    Cudd fresh;
+    vector<BDD> w;
+    for (uint i = 0; i < 4; ++i)
+    {
+        w.push_back(fresh.bddVar((int)i));
+        fresh.pushVariableName("v" + to_string(i));
+    }
+    auto bdd_by_name = load_bdds(fresh, file_name, {"g"}, false);
+    ASSERT_TRUE(bdd_by_name.has_value());
+    ASSERT_EQ(1, bdd_by_name->size());
+    ASSERT_TRUE(bdd_by_name->at("g") == (w[1] & w[3]));
+    for (int i = 0; i < 4; ++i)
+        ASSERT_EQ(i, fresh.ReadPerm(i)) << "variable " << i;
+}
+
+
+/**
+  * Checking the signal pruning on a UCW with binate signals (r, g), unate ones (the input u, the output h),
+  * and absent ones (the input a, the output b)
+**/
+TEST(SignalPruningTest, unate_and_absent_signals)
+{
+    auto r = spot::formula::ap("r"), u = spot::formula::ap("u"), a = spot::formula::ap("a");
+    auto g = spot::formula::ap("g"), h = spot::formula::ap("h"), b = spot::formula::ap("b");
+
+    auto aut = spot::make_twa_graph(spot::make_bdd_dict());
+    auto var = [&](const spot::formula& signal) { return bdd_ithvar(aut->register_ap(signal)); };
+    auto nvar = [&](const spot::formula& signal) { return bdd_nithvar(aut->register_ap(signal)); };
+    auto r_eq_g = (var(r) & var(g)) | (nvar(r) & nvar(g));
+    auto r_neq_g = (var(r) & nvar(g)) | (nvar(r) & var(g));
+    aut->set_buchi();
+    aut->prop_state_acc(true);
+    aut->new_states(2);
+    aut->set_init_state(0);
+    aut->new_edge(0, 0, r_eq_g & var(u));    // (u=1 enables more: the input is fixed to 1)
+    aut->new_edge(0, 1, r_neq_g | var(h));   // (h=0 enables fewer: the output is fixed to 0)
+    aut->new_acc_edge(1, 1, bddtrue);
+
+    auto pruned = prune_signals(aut, {r, u, a}, {g, h, b});
+    ASSERT_EQ(unordered_set<spot::formula>({r}), pruned.inputs);
+    ASSERT_EQ(unordered_set<spot::formula>({g}), pruned.outputs);
+    ASSERT_EQ(vector<spot::formula>({a, u}), pruned.free_inputs);
+    ASSERT_EQ((vector<pair<spot::formula, bool>>({{b, false}, {h, false}})), pruned.fixed_outputs);
+
+    // the labels are restricted to the fixed values, the original automaton is intact
+    ASSERT_NE(aut, pruned.aut);
+    ASSERT_EQ(3u, pruned.aut->num_edges());
+    for (const auto& e: pruned.aut->edges())
+        ASSERT_TRUE(e.src != 0 || e.cond == (e.dst == 0 ? r_eq_g : r_neq_g));
+    for (const auto& e: aut->edges())
+        ASSERT_TRUE(e.src != 0 || e.dst != 0 || e.cond == (r_eq_g & var(u)));
+
+    // the model of the pruned game (g = r) gets the dropped inputs and the constant outputs
+    aiger* model = aiger_init();
+    aiger_add_input(model, 2, "r");
+    aiger_add_output(model, 2, "g");
+    restore_signals(model, pruned);
+    ASSERT_EQ(3u, model->num_inputs);
+    ASSERT_STREQ("a", model->inputs[1].name);
+    ASSERT_EQ(4u, model->inputs[1].lit);
+    ASSERT_STREQ("u", model->inputs[2].name);
+    ASSERT_EQ(6u, model->inputs[2].lit);
+    ASSERT_EQ(3u, model->num_outputs);
+    ASSERT_STREQ("b", model->outputs[1].name);
+    ASSERT_EQ(0u, model->outputs[1].lit);
+    ASSERT_STREQ("h", model->outputs[2].name);
+    ASSERT_EQ(0u, model->outputs[2].lit);
+    ASSERT_EQ(nullptr, aiger_check(model));
+    aiger_reset(model);
+}
+
+
+/**
+  * Checking the cluster mode: a coordinator and two local nodes (over a Unix domain socket)
+**/
+TEST(ClusterTest, two_local_nodes)
+{
+    auto address = "unix:" + create_tmp_folder() + "/coordinator.sock";
+    vector<pid_t> nodes;
+    for (uint n = 0; n < 2; ++n)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+            _exit(run_node(address, 2));
+        nodes.push_back(pid);
+    }
+
+    BatchDescr batch_descr;
+    for (const auto& spec: specs)
+        batch_descr.spec_files.push_back("./specs/" + spec.name);
+    // (the nodes get the options from the coordinator)
+    batch_descr.extract_model = true;
+    batch_descr.do_reach_optim = true;
+    batch_descr.tuning.translation_level = TranslationLevel::low;
+    batch_descr.tuning.extract_method = ExtractMethod::squeeze;
+    batch_descr.tuning.reorder_policy = ReorderPolicy::adaptive;
+
+    testing::internal::CaptureStdout();
+    auto rc = run_coordinator(batch_descr, address);
+    auto lines = testing::internal::GetCapturedStdout();
+    for (auto pid: nodes)
+        waitpid(pid, nullptr, 0);
+    ASSERT_EQ(0, rc);
+
+    ASSERT_NO_FATAL_FAILURE(check_verdict_lines(lines));
+    ASSERT_NE(string::npos, lines.find("\"specs\": " + to_string(specs.size()) + ", ")) << lines;
+    ASSERT_NE(string::npos, lines.find("\"ERROR\": 0, ")) << lines;
+}
+
+
+/** @return the socket connected to the Unix domain socket `socket_path` (waits until it is listened on) */
+int connect_unix(const string& socket_path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    for (int attempt = 0; connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0; ++attempt)
+    {
+        MASSERT(attempt < 100, "could not connect to " << socket_path);
+        usleep(50000);  // (the peer is starting)
+    }
+    return fd;
+}
+
+
+/**
+  * Checking the reassignment: a node takes a spec and dies without answering,
+  * the spec is solved by the node that joins next
+**/
+TEST(ClusterTest, node_dies_mid_job)
+{
+    auto socket_path = create_tmp_folder() + "/coordinator.sock";
+    auto address = "unix:" + socket_path;
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // the dying node speaks the protocol (see cluster.hpp) until it gets its job
+        int fd = connect_unix(socket_path);
+        string hello = "HELLO 1 0\n";
+        MASSERT(write(fd, hello.data(), hello.size()) == (ssize_t) hello.size(), "");
+        string received;
+        char chunk[4096];
+        for (ssize_t n; received.find("JOB ") == string::npos && (n = read(fd, chunk, sizeof(chunk))) > 0; )
+            received.append(chunk, n);
+        close(fd);
+        _exit(run_node(address, 2));
+    }
+
+    BatchDescr batch_descr;
+    for (const auto& spec: specs)
+        batch_descr.spec_files.push_back("./specs/" + spec.name);
+
+    testing::internal::CaptureStdout();
+    auto rc = run_coordinator(batch_descr, address);
+    auto lines = testing::internal::GetCapturedStdout();
+    waitpid(pid, nullptr, 0);
+    ASSERT_EQ(0, rc);
+
+    ASSERT_NO_FATAL_FAILURE(check_verdict_lines(lines));
+    ASSERT_NE(string::npos, lines.find("\"ERROR\": 0, ")) << lines;
+    ASSERT_NE(string::npos, lines.find("\"nodes\": 2, \"reassigned\": 1, ")) << lines;
+}
+
+
+/**
+  * Checking the server: the same spec twice (the second time the translation comes from the cache)
+**/
+string ask_server(const string& socket_path, const string& request)
+{
+    int fd = connect_unix(socket_path);
+    MASSERT(write(fd, request.data(), request.size()) == (ssize_t) request.size(), "");
+    shutdown(fd, SHUT_WR);
+    string response;
+    char chunk[4096];
+    for (ssize_t n; (n = read(fd, chunk, sizeof(chunk))) > 0; )
+        response.append(chunk, n);
+    close(fd);
+    return response;
+}
+
+TEST(ServerTest, solve_twice)
+{
+    auto socket_path = create_tmp_folder() + "/sdf.sock";
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        ServerDescr server_descr;
+        server_descr.socket_path = socket_path;
+        server_descr.max_jobs = 2;
+        _exit(run_server(server_descr));
+    }
+
+    auto request = "k: 2 4\nmodel: false\n\n" + readfile("./specs/full_arbiter.tlsf");
+    auto first = ask_server(socket_path, request);
+    auto second = ask_server(socket_path, request);
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+
+    ASSERT_NE(string::npos, first.find("status: " SYNTCOMP_STR_REAL "\n")) << first;
+    ASSERT_NE(string::npos, first.find("cached: false\n")) << first;
+    ASSERT_NE(string::npos, second.find("status: " SYNTCOMP_STR_REAL "\n")) << second;
+    ASSERT_NE(string::npos, second.find("cached: true\n")) << second;
+}
+
+
+/**
+  * Checking the TLSF front end against syfco
+**/
+class TlsfParserFixture : public ::testing::TestWithParam<SpecParam> { };
+
+TEST_P(TlsfParserFixture, same_as_syfco)
+{
+    auto spec_path = "./specs/" + GetParam().name;
+    ifstream file(spec_path);
+    stringstream text;
+    text << file.rdbuf();
+    auto spec = parse_tlsf_text(text.str());
+
+    int rc;
+    string out, err;
+    tie(rc, out, err) = execute("syfco -f ltl -m fully -q double " + spec_path);
+    ASSERT_EQ(0, rc);
+    auto syfco_formula = spot::parse_infix_psl(out);
+    ASSERT_TRUE(syfco_formula.errors.empty());
+    ASSERT_TRUE(spot::are_equivalent(syfco_formula.f, spec.formula));
+
+    tie(rc, out, err) = execute("syfco -ins " + spec_path);
+    ASSERT_EQ(split_by_space(substituteAll(out, ",", " ")), spec.inputs);
+
+    tie(rc, out, err) = execute("syfco -outs " + spec_path);
+    ASSERT_EQ(split_by_space(substituteAll(out, ",", " ")), spec.outputs);
+
+    tie(rc, out, err) = execute("syfco -g " + spec_path);
+    ASSERT_EQ(lower(trim_spaces(out)) == "moore", spec.is_moore_target);
+}
+
+INSTANTIATE_TEST_SUITE_P(Specs, TlsfParserFixture, ::testing::ValuesIn(specs));
+
+
 /**
   * Checking Synthesis: extract and model check the models
 **/
@@ -108,19 +710,21 @@ const vector<string> specs_for_mc =
 //    "round_robin_arbiter2.tlsf",  // MC takes a long time
     "prioritized_arbiter.tlsf",
     "mealy_moore_real.tlsf",
-    "outputs_only.tlsf"
+    "outputs_only.tlsf",
+    "testing_unknown_APs.tlsf"
 };
 
-class SyntWithMCFixture: public ::testing::TestWithParam<string>
+template<typename Param>
+class TmpFolderFixture: public ::testing::TestWithParam<Param>
 {
 public:
     const string tmpFolder;
 
-    SyntWithMCFixture() : tmpFolder(create_tmp_folder())
+    TmpFolderFixture() : tmpFolder(create_tmp_folder())
     {
         cout << "(TEST) Using tmp folder: " << tmpFolder << endl;
     }
-    ~SyntWithMCFixture() override
+    ~TmpFolderFixture() override
     {
         // TODO: rewrite: hackish: we need to remove the non-empty dir so `rmdir` does not work
         string cmd = "rm -rf " + tmpFolder;
@@ -129,15 +733,10 @@ public:
     }
 };
 
-void synt_and_verify_common(const string& spec, const string& tmpFolder, bool reach_optimisation)
-{
-    auto specPath = "./specs/" + spec;
-    auto modelPath = tmpFolder + "/" + spec + ".aag";
-    cout << "(TEST) SYNTHESIS..." << endl;
-    auto status = run_tlsf(SpecDescr(false, specPath, true, reach_optimisation, modelPath), {2,4});
-    ASSERT_EQ(SYNTCOMP_RC_REAL, status);
-    cout << "(TEST) SYNTHESIS: SUCCESS!" << endl;
+using SyntWithMCFixture = TmpFolderFixture<string>;
 
+void verify_model(const string& modelPath, const string& specPath)
+{
     cout << "(TEST) VERIFICATION..." << endl;
     int rc;
     string out, err;
@@ -154,6 +753,25 @@ void synt_and_verify_common(const string& spec, const string& tmpFolder, bool re
     cout << "(TEST) VERIFICATION: SUCCESS!" << endl;
 }
 
+void synt_and_verify_common(const string& spec, const string& tmpFolder, bool reach_optimisation,
+                            SolverEngine engine = SolverEngine::symbolic,
+                            uint nof_portfolio_configs = 0,
+                            const SolverTuning& tuning = SolverTuning())
+{
+    auto specPath = "./specs/" + spec;
+    auto modelPath = tmpFolder + "/" + spec + ".aag";
+    cout << "(TEST) SYNTHESIS..." << endl;
+    auto spec_descr = SpecDescr(false, specPath, true, reach_optimisation, modelPath, engine,
+                                 KBoundPolicy::uniform, 0, tuning);
+    auto status = nof_portfolio_configs > 0
+                  ? run_portfolio(spec_descr, {2,4}, PortfolioDescr{nof_portfolio_configs, 0, 1})
+                  : run_tlsf(spec_descr, {2,4});
+    ASSERT_EQ(SYNTCOMP_RC_REAL, status);
+    cout << "(TEST) SYNTHESIS: SUCCESS!" << endl;
+
+    verify_model(modelPath, specPath);
+}
+
 TEST_P(SyntWithMCFixture, synt_and_verify)
 {
     synt_and_verify_common(GetParam(), tmpFolder, false);
@@ -164,10 +782,180 @@ TEST_P(SyntWithMCFixture, synt_and_verify_optim)
     synt_and_verify_common(GetParam(), tmpFolder, true);
 }
 
+TEST_P(SyntWithMCFixture, synt_and_verify_portfolio)
+{
+    synt_and_verify_common(GetParam(), tmpFolder, false, SolverEngine::symbolic, 6);
+}
+
+TEST_P(SyntWithMCFixture, synt_and_verify_extract_best)
+{
+    SolverTuning tuning;
+    tuning.extract_method = ExtractMethod::best;
+    synt_and_verify_common(GetParam(), tmpFolder, true, SolverEngine::symbolic, 0, tuning);
+}
+
+TEST_P(SyntWithMCFixture, synt_and_verify_extract_order_search)
+{
+    SolverTuning tuning;
+    tuning.extract_order = ExtractOrder::search;
+    synt_and_verify_common(GetParam(), tmpFolder, false, SolverEngine::symbolic, 0, tuning);
+}
+
+TEST_P(SyntWithMCFixture, synt_and_verify_anytime)
+{
+    SolverTuning tuning;
+    tuning.anytime_sec = 60;
+    synt_and_verify_common(GetParam(), tmpFolder, true, SolverEngine::symbolic, 0, tuning);
+}
+
+TEST_P(SyntWithMCFixture, synt_and_verify_adaptive_reordering)
+{
+    SolverTuning tuning;
+    tuning.reorder_policy = ReorderPolicy::adaptive;
+    synt_and_verify_common(GetParam(), tmpFolder, false, SolverEngine::symbolic, 0, tuning);
+}
+
+TEST_P(SyntWithMCFixture, synt_and_verify_no_signal_pruning)
+{
+    SolverTuning tuning;
+    tuning.prune_signals = false;
+    synt_and_verify_common(GetParam(), tmpFolder, false, SolverEngine::symbolic, 0, tuning);
+}
+
 INSTANTIATE_TEST_SUITE_P(SyntWithMC,
                          SyntWithMCFixture,
                          ::testing::ValuesIn(specs_for_mc));
 
+using EngineSyntWithMCFixture = TmpFolderFixture<tuple<string, SolverEngine>>;
+
+TEST_P(EngineSyntWithMCFixture, synt_and_verify)
+{
+    auto [spec, engine] = GetParam();
+    synt_and_verify_common(spec, tmpFolder, false, engine);
+}
+
+INSTANTIATE_TEST_SUITE_P(SyntWithMC,
+                         EngineSyntWithMCFixture,
+                         ::testing::Combine(::testing::ValuesIn(specs_for_mc), ::testing::ValuesIn(other_engines)));
+
+
+/**
+  * Checking the memory ceiling: a ceiling a bit above the memory of a fresh CUDD manager
+  * puts the extraction under pressure from the start, so it takes the cheaper paths, and the model is still correct
+**/
+TEST(MemoryTest, fallbacks_under_pressure)
+{
+    Cudd probe;  // (the unique table and the cache a fresh manager starts with)
+    SolverTuning tuning;
+    tuning.memory_mb = (uint) ((double) probe.ReadMemoryInUse() * 1.4 / (1 << 20));  // (its MEMORY_PRESSURE_RATIO is below that)
+
+    string specPath = "./specs/simple_arbiter.tlsf";
+    auto [formula, inputs, outputs, is_moore] = parse_tlsf(specPath);
+    // (the feedback policy retries with its own bounds by SCC, and needs the antichain engine)
+    for (auto [engine, k_policy]: {pair(SolverEngine::symbolic, KBoundPolicy::uniform),
+                                   pair(SolverEngine::antichain, KBoundPolicy::feedback)})
+    {
+        SpecDescr2<spot::formula> spec_descr(formula, inputs, outputs, is_moore, true, true,
+                                             engine, k_policy, 0, nullptr, tuning);
+        aiger* model = nullptr;
+        SynthStats stats;
+        ASSERT_TRUE(synthesize_formula(spec_descr, {2, 4}, model, &stats));
+        ASSERT_NE(nullptr, model);
+        ASSERT_FALSE(stats.memory_fallbacks.empty());
+
+        auto modelPath = create_tmp_folder() + "/simple_arbiter.aag";
+        aiger_open_and_write_to_file(model, modelPath.c_str());
+        aiger_reset(model);
+        verify_model(modelPath, specPath);
+    }
+}
+
+
+/**
+  * Checking the checkpoint: solve and save, resume with the output functions (no extraction),
+  * resume without them (re-extraction); the checkpoint files are rewritten only when their BDDs are recomputed
+**/
+TEST(CheckpointTest, resume_and_re_extract)
+{
+    auto tmpFolder = create_tmp_folder();
+    SolverTuning tuning;
+    tuning.checkpoint_file = tmpFolder + "/checkpoint";
+    auto outputs_file = tuning.checkpoint_file + CHECKPOINT_OUTPUTS_SUFFIX;
+
+    ASSERT_NO_FATAL_FAILURE(synt_and_verify_common("full_arbiter.tlsf", tmpFolder, false, SolverEngine::symbolic, 0, tuning));
+    ASSERT_TRUE(filesystem::exists(tuning.checkpoint_file));
+    ASSERT_TRUE(filesystem::exists(outputs_file));
+    auto game_time = filesystem::last_write_time(tuning.checkpoint_file);
+    auto outputs_time = filesystem::last_write_time(outputs_file);
+
+    tuning.resume = true;
+    ASSERT_NO_FATAL_FAILURE(synt_and_verify_common("full_arbiter.tlsf", tmpFolder, false, SolverEngine::symbolic, 0, tuning));
+    ASSERT_TRUE(game_time == filesystem::last_write_time(tuning.checkpoint_file));
+    ASSERT_TRUE(outputs_time == filesystem::last_write_time(outputs_file));
+
+    tuning.re_extract = true;
+    ASSERT_NO_FATAL_FAILURE(synt_and_verify_common("full_arbiter.tlsf", tmpFolder, false, SolverEngine::symbolic, 0, tuning));
+    ASSERT_TRUE(game_time == filesystem::last_write_time(tuning.checkpoint_file));
+    ASSERT_TRUE(outputs_time != filesystem::last_write_time(outputs_file));
+}
+
+
+/**
+  * Checking the reachability optimization of the symbolic engine:
+  * the explicit exploration of the macro-states, and the symbolic reachability once the exploration gives up
+**/
+class ExplicitReachSolver : public GameSolver
+{
+public:
+    ExplicitReachSolver(bool is_moore_,
+                        const unordered_set<spot::formula>& inputs_,
+                        const unordered_set<spot::formula>& outputs_,
+                        const spot::twa_graph_ptr& aut_,
+                        uint explicit_reach_bound_) :
+        GameSolver(is_moore_, inputs_, outputs_, aut_, true)
+    {
+        explicit_reach_bound = explicit_reach_bound_;
+    }
+
+    optional<bool> is_explicit;  // (set by compute_reachable_explicitly)
+
+protected:
+    optional<BDD> compute_reachable_explicitly() override
+    {
+        auto reachable = GameSolver::compute_reachable_explicitly();
+        is_explicit = reachable.has_value();
+        return reachable;
+    }
+};
+
+void synt_and_verify_explicit_reach(uint explicit_reach_bound, bool expect_explicit)
+{
+    string specPath = "./specs/full_arbiter.tlsf";
+    auto [formula, inputs, outputs, is_moore] = parse_tlsf(specPath);
+    auto ucw = translate_to_ucw(formula);
+    ExplicitReachSolver solver(is_moore, inputs, outputs, k_reduce(ucw, uniform_k_by_scc(ucw, 4)), explicit_reach_bound);
+    aiger* model = solver.synthesize();
+    ASSERT_NE(nullptr, model);
+    ASSERT_TRUE(solver.is_explicit.has_value());
+    ASSERT_EQ(expect_explicit, *solver.is_explicit);
+
+    auto tmpFolder = create_tmp_folder();
+    auto modelPath = tmpFolder + "/full_arbiter.aag";
+    aiger_open_and_write_to_file(model, modelPath.c_str());
+    aiger_reset(model);
+    verify_model(modelPath, specPath);
+}
+
+TEST(ExplicitReachTest, explores_all_macro_states)
+{
+    synt_and_verify_explicit_reach(R_OPTIM_EXPLICIT_BOUND, true);
+}
+
+TEST(ExplicitReachTest, gives_up_at_the_bound)
+{
+    synt_and_verify_explicit_reach(1, false);
+}
+
 
 /**
   * Checking Synthesis from HOA: only the realisability check
@@ -197,6 +985,25 @@ TEST_P(HOACheckFixture, check_real_unreal)
 INSTANTIATE_TEST_SUITE_P(RealUnreal, HOACheckFixture, ::testing::ValuesIn(specs_for_hoa_synt));
 
 
+/**
+  * Checking the accepting sinks (they have no latches): mealy_moore.ehoa whose accepting sink also has an edge leaving it
+  * (to a state reachable only that way), which changes nothing since the run staying in the sink is rejecting anyway.
+  * The game is built right on the automaton, which the simulation-based reduction of the k-reduced one would simplify.
+**/
+TEST(HOASyntTest, accepting_sink_with_exits)
+{
+    auto [aut, inputs, outputs, is_moore] = read_ehoa("./specs/hoa/mealy_moore_sink_exits.ehoa");
+    GameSolver solver(is_moore, inputs, outputs, aut, false);
+    aiger* model = solver.synthesize();
+    ASSERT_NE(nullptr, model);
+
+    auto modelPath = create_tmp_folder() + "/mealy_moore_sink_exits.aag";
+    aiger_open_and_write_to_file(model, modelPath.c_str());
+    aiger_reset(model);
+    verify_model(modelPath, "./specs/mealy_moore_real.tlsf");
+}
+
+
 /// For future: good to check the exact values of parameter k that makes specs realizable.
 
 int main(int argc, char** argv)